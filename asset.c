@@ -0,0 +1,450 @@
+/*
+
+NOTE(Nader): stb_image is compiled into the game so decoding can run as queue work. It
+allocates out of the arena of the task it is decoding for (asset_decode_arena, set for
+the length of a job), frees are no-ops and the whole arena goes when the task does.
+Running out of arena just makes the decode fail.
+
+*/
+global thread_local_storage MemoryArena *asset_decode_arena;
+
+internal void *
+asset_decode_allocate(u64 size)
+{
+    void *result = 0;
+    MemoryArena *arena = asset_decode_arena;
+    if (arena && (size <= get_arena_size_remaining(arena, DEFAULT_ARENA_ALIGNMENT)))
+    {
+        result = push_size(arena, size);
+    }
+    return(result);
+}
+
+internal void *
+asset_decode_reallocate(void *old_memory, u64 old_size, u64 new_size)
+{
+    void *result = asset_decode_allocate(new_size);
+    if (result && old_memory)
+    {
+        memcpy(result, old_memory, HMM_MIN(old_size, new_size));
+    }
+    return(result);
+}
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_STATIC
+#define STBI_ONLY_PNG
+#define STBI_ONLY_JPEG
+#define STBI_NO_STDIO
+#define STBI_MALLOC(size) asset_decode_allocate(size)
+#define STBI_REALLOC_SIZED(memory, old_size, new_size) asset_decode_reallocate(memory, old_size, new_size)
+#define STBI_FREE(memory) ((void)(memory))
+#include "stb_image.h"
+
+// NOTE(Nader): Relative to the working directory.
+global char *bitmap_filepaths[BitmapId_Count] =
+{
+    0,
+    "data/player.png",
+};
+
+// NOTE(Nader): Enough to decode the pack's largest bitmap from a loose file, see asset.h.
+internal u64
+get_asset_task_arena_size(AssetPack *pack)
+{
+    u64 result = ASSET_LOOSE_TASK_ARENA_SIZE;
+    if (pack && pack->entry_count)
+    {
+        u64 largest_bitmap_size = 0;
+        for (u32 entry_index = 0; entry_index < pack->entry_count; ++entry_index)
+        {
+            // NOTE(Nader): Same bounds check as find_asset_pack_entry, a bad entry can't size the arenas.
+            AssetPackEntry *entry = &pack->entries[entry_index];
+            if ((entry->type == AssetPackEntryType_Bitmap) &&
+                (entry->data_offset <= pack->size) && (entry->data_size <= (pack->size - entry->data_offset)))
+            {
+                largest_bitmap_size = HMM_MAX(largest_bitmap_size, entry->data_size);
+            }
+        }
+        result = HMM_MAX(ASSET_TASK_ARENA_PIXEL_FACTOR*largest_bitmap_size, ASSET_MIN_TASK_ARENA_SIZE);
+    }
+    return(result);
+}
+
+internal void
+initialize_assets(Assets *assets, MemoryArena *arena, AssetPack *pack)
+{
+    sub_arena(&assets->storage, arena, "assets", ASSET_STORAGE_SIZE);
+    assets->task_arena_size = get_asset_task_arena_size(pack);
+    for (u32 task_index = 0; task_index < ASSET_TASK_COUNT; ++task_index)
+    {
+        AssetTask *task = &assets->tasks[task_index];
+        task->is_in_use = false;
+        sub_arena(&task->arena, arena, "asset task", assets->task_arena_size);
+    }
+    for (u32 bitmap_index = 0; bitmap_index < BitmapId_Count; ++bitmap_index)
+    {
+        AssetSlot *slot = &assets->bitmaps[bitmap_index];
+        slot->state = AssetState_Unloaded;
+        slot->task = 0;
+        slot->filepath = bitmap_filepaths[bitmap_index];
+        slot->page = 0;
+    }
+    assets->atlas_page_count = 0;
+    assets->next_texture_handle = 1;
+    assets->loaded_count = 0;
+    assets->failed_count = 0;
+    assets->max_upload_bytes_in_a_frame = 0;
+}
+
+internal AssetTask *
+begin_asset_task(Assets *assets)
+{
+    AssetTask *result = 0;
+    for (u32 task_index = 0; task_index < ASSET_TASK_COUNT; ++task_index)
+    {
+        AssetTask *task = &assets->tasks[task_index];
+        if (!task->is_in_use)
+        {
+            task->is_in_use = true;
+            reset_arena(&task->arena);
+            result = task;
+            break;
+        }
+    }
+    return(result);
+}
+
+internal void
+end_asset_task(AssetTask *task)
+{
+    task->is_in_use = false;
+}
+
+typedef struct LoadBitmapWork
+{
+    AssetSlot *slot;
+    AssetTask *task;
+    char *filepath;
+    AssetPack *pack;
+    platform_read_entire_file *read_entire_file;
+} LoadBitmapWork;
+
+/*
+
+NOTE(Nader): A bitmap in the pack is already decoded, so all the job does is touch every
+page of it. That way the page faults (the actual disk reads) happen here and not on the
+main thread when it uploads. Bitmaps the pack doesn't have are read from their file and
+decoded.
+
+*/
+internal PLATFORM_WORK_QUEUE_CALLBACK(do_load_bitmap_work)
+{
+    LoadBitmapWork *work = (LoadBitmapWork *)data;
+    AssetSlot *slot = work->slot;
+    MemoryArena *arena = &work->task->arena;
+
+    u32 state = AssetState_Failed;
+    AssetPackEntry *entry = find_asset_pack_entry(work->pack, work->filepath);
+    if (entry && (entry->type == AssetPackEntryType_Bitmap) &&
+        (entry->data_size == (u64)entry->width*entry->height*sizeof(u32)))
+    {
+        u8 *pixels = (u8 *)get_asset_pack_data(work->pack, entry);
+        u32 volatile page_sum = 0;
+        for (u64 offset = 0; offset < entry->data_size; offset += 4096)
+        {
+            page_sum += pixels[offset];
+        }
+
+        slot->bitmap.width = entry->width;
+        slot->bitmap.height = entry->height;
+        slot->bitmap.pixels = 0;
+        slot->decoded_pixels = (u32 *)pixels;
+        slot->decoded_pixels_are_in_pack = true;
+        slot->uploaded_row_count = 0;
+        state = AssetState_Decoded;
+    }
+    else
+    {
+        PlatformFileContents file = work->read_entire_file(work->filepath, arena);
+        if (file.contents)
+        {
+            asset_decode_arena = arena;
+            stbi_set_flip_vertically_on_load_thread(true);
+            int width, height, component_count;
+            u8 *rgba = stbi_load_from_memory((stbi_uc *)file.contents, (int)file.size,
+                                             &width, &height, &component_count, 4);
+            asset_decode_arena = 0;
+            if (rgba)
+            {
+                convert_rgba_to_premultiplied_argb(rgba, (u32)width*(u32)height);
+                slot->bitmap.width = (u32)width;
+                slot->bitmap.height = (u32)height;
+                slot->bitmap.pixels = 0;
+                slot->decoded_pixels = (u32 *)rgba;
+                slot->decoded_pixels_are_in_pack = false;
+                slot->uploaded_row_count = 0;
+                state = AssetState_Decoded;
+            }
+        }
+    }
+
+    // NOTE(Nader): The main thread reads the bitmap as soon as it sees the new state.
+    complete_previous_writes_before_future_writes;
+    slot->state = state;
+}
+
+// NOTE(Nader): Does nothing if the slot is already on its way, or if every task is busy (try again next frame).
+internal void
+load_asset_slot(Assets *assets, GameMemory *memory, AssetSlot *slot)
+{
+    if (slot->state == AssetState_Unloaded)
+    {
+        AssetTask *task = begin_asset_task(assets);
+        if (task)
+        {
+            LoadBitmapWork *work = push_struct(&task->arena, LoadBitmapWork);
+            work->slot = slot;
+            work->task = task;
+            work->filepath = slot->filepath;
+            work->pack = memory->asset_pack;
+            work->read_entire_file = memory->platform_read_entire_file;
+
+            slot->task = task;
+            slot->state = AssetState_Queued;
+            memory->platform_add_entry(memory->low_priority_queue, do_load_bitmap_work, work);
+        }
+    }
+}
+
+// NOTE(Nader): The page's slot, made the first time one of its regions is asked for. 0 if there's no room for another.
+internal AssetSlot *
+get_atlas_page(Assets *assets, char *page_name)
+{
+    AssetSlot *result = 0;
+    for (u32 page_index = 0; page_index < assets->atlas_page_count; ++page_index)
+    {
+        AssetSlot *page = &assets->atlas_pages[page_index];
+        if (strncmp(page->filepath, page_name, ASSET_PACK_MAX_NAME_LENGTH) == 0)
+        {
+            result = page;
+            break;
+        }
+    }
+    if (!result && (assets->atlas_page_count < ASSET_MAX_ATLAS_PAGES))
+    {
+        result = &assets->atlas_pages[assets->atlas_page_count++];
+        result->state = AssetState_Unloaded;
+        result->task = 0;
+        result->filepath = page_name;
+        result->page = 0;
+    }
+    return(result);
+}
+
+/*
+
+NOTE(Nader): A region only needs its pack entry to know where it sits on its page, which
+is a lookup in the entry table, so that part happens right here. The pack is mapped for
+as long as the game runs, page_name can be kept pointing into it.
+
+*/
+internal void
+load_bitmap(Assets *assets, GameMemory *memory, BitmapId id)
+{
+    AssetSlot *slot = &assets->bitmaps[id];
+    if ((id != BitmapId_None) && (slot->state == AssetState_Unloaded))
+    {
+        AssetPack *pack = memory->asset_pack;
+        AssetPackEntry *entry = find_asset_pack_entry(pack, slot->filepath);
+        if (entry && (entry->type == AssetPackEntryType_AtlasRegion))
+        {
+            AssetPackAtlasRegion *region = (AssetPackAtlasRegion *)get_asset_pack_data(pack, entry);
+            AssetPackEntry *page_entry = 0;
+            if ((entry->data_size == sizeof(AssetPackAtlasRegion)) &&
+                (region->page_name[ASSET_PACK_MAX_NAME_LENGTH - 1] == 0))
+            {
+                page_entry = find_asset_pack_entry(pack, region->page_name);
+            }
+
+            AssetSlot *page = 0;
+            if (page_entry && (page_entry->type == AssetPackEntryType_Bitmap) &&
+                ((u64)region->x + region->width <= page_entry->width) &&
+                ((u64)region->y + region->height <= page_entry->height))
+            {
+                page = get_atlas_page(assets, region->page_name);
+            }
+
+            if (page)
+            {
+                f32 page_width = (f32)page_entry->width;
+                f32 page_height = (f32)page_entry->height;
+                slot->bitmap.width = region->width;
+                slot->bitmap.height = region->height;
+                slot->bitmap.pixels = 0;
+                slot->bitmap.uv_rect = v4(region->x / page_width, region->y / page_height,
+                                          region->width / page_width, region->height / page_height);
+                slot->page = page;
+                slot->state = AssetState_Queued;
+            }
+            else
+            {
+                // TODO(Nader): Logging.
+                slot->state = AssetState_Failed;
+                ++assets->failed_count;
+            }
+        }
+        else
+        {
+            load_asset_slot(assets, memory, slot);
+        }
+    }
+
+    // NOTE(Nader): Retried every call, in case every task was busy the first time.
+    if (slot->page)
+    {
+        load_asset_slot(assets, memory, slot->page);
+    }
+}
+
+internal LoadedBitmap *
+get_bitmap(Assets *assets, BitmapId id)
+{
+    LoadedBitmap *result = 0;
+    AssetSlot *slot = &assets->bitmaps[id];
+    if (slot->page && (slot->state == AssetState_Queued))
+    {
+        if (slot->page->state == AssetState_Loaded)
+        {
+            slot->bitmap.pixels = slot->page->bitmap.pixels;
+            slot->bitmap.texture_handle = slot->page->bitmap.texture_handle;
+            slot->state = AssetState_Loaded;
+            ++assets->loaded_count;
+        }
+        else if (slot->page->state == AssetState_Failed)
+        {
+            slot->state = AssetState_Failed;
+            ++assets->failed_count;
+        }
+    }
+
+    if (slot->state == AssetState_Loaded)
+    {
+        result = &slot->bitmap;
+    }
+    return(result);
+}
+
+// NOTE(Nader): Sends as much of a decoded slot as fits in what's left of the frame's budget, false once the budget is gone.
+internal b32
+upload_decoded_slot(Assets *assets, RenderCommands *commands, AssetSlot *slot, u32 *upload_bytes)
+{
+    b32 result = true;
+    u32 state = slot->state;
+    if (slot->task && ((state == AssetState_Decoded) || (state == AssetState_Failed)))
+    {
+        complete_previous_reads_before_future_reads;
+
+        LoadedBitmap *bitmap = &slot->bitmap;
+        if ((state == AssetState_Decoded) && !bitmap->pixels)
+        {
+            // NOTE(Nader): First band, find it a home. The pack's copy lives as long as the mapping, so it can stay put.
+            u32 size = bitmap->width*bitmap->height*sizeof(u32);
+            if (slot->decoded_pixels_are_in_pack && (assets->next_texture_handle < MAX_RENDER_TEXTURES))
+            {
+                bitmap->pixels = slot->decoded_pixels;
+                bitmap->texture_handle = assets->next_texture_handle++;
+            }
+            else if ((size <= get_arena_size_remaining(&assets->storage, DEFAULT_ARENA_ALIGNMENT)) &&
+                     (assets->next_texture_handle < MAX_RENDER_TEXTURES))
+            {
+                bitmap->pixels = (u32 *)push_size(&assets->storage, size);
+                bitmap->texture_handle = assets->next_texture_handle++;
+            }
+            else
+            {
+                // TODO(Nader): Logging, and evict something instead, see asset.h.
+                state = slot->state = AssetState_Failed;
+            }
+            bitmap->uv_rect = v4(0.0f, 0.0f, 1.0f, 1.0f);
+        }
+
+        b32 is_done = true;
+        if (state == AssetState_Decoded)
+        {
+            u32 row_size = bitmap->width*sizeof(u32);
+            u32 row_count = bitmap->height - slot->uploaded_row_count;
+            u32 rows_in_budget = (ASSET_UPLOAD_BYTES_PER_FRAME - HMM_MIN(*upload_bytes, ASSET_UPLOAD_BYTES_PER_FRAME)) / row_size;
+            if (!*upload_bytes)
+            {
+                rows_in_budget = HMM_MAX(rows_in_budget, 1);
+            }
+            row_count = HMM_MIN(row_count, rows_in_budget);
+            if (row_count && (commands->texture_upload_count < commands->max_texture_upload_count))
+            {
+                u32 first_row = slot->uploaded_row_count;
+                if (bitmap->pixels != slot->decoded_pixels)
+                {
+                    memcpy(bitmap->pixels + first_row*bitmap->width, slot->decoded_pixels + first_row*bitmap->width,
+                           row_count*row_size);
+                }
+                push_texture_upload(commands, bitmap->texture_handle, bitmap->width, bitmap->height,
+                                    first_row, row_count, bitmap->pixels);
+                slot->uploaded_row_count += row_count;
+                *upload_bytes += row_count*row_size;
+            }
+
+            if (slot->uploaded_row_count < bitmap->height)
+            {
+                // NOTE(Nader): Out of budget before the end of this one.
+                is_done = false;
+                result = false;
+            }
+            else
+            {
+                slot->state = AssetState_Loaded;
+                ++assets->loaded_count;
+            }
+        }
+        else
+        {
+            ++assets->failed_count;
+        }
+
+        if (is_done)
+        {
+            slot->decoded_pixels = 0;
+            end_asset_task(slot->task);
+            slot->task = 0;
+        }
+    }
+    return(result);
+}
+
+/*
+
+NOTE(Nader): Call once a frame, between render_commands_begin and the first draw that
+might use a bitmap, so a bitmap whose last rows go out here can already be drawn this
+frame. Always sends at least one row, so the budget can't stall a wide bitmap. Atlas
+pages go first, one page usually brings in a lot of bitmaps.
+
+*/
+internal void
+upload_decoded_bitmaps(Assets *assets, RenderCommands *commands)
+{
+    u32 upload_bytes = 0;
+    b32 budget_left = true;
+    for (u32 page_index = 0; budget_left && (page_index < assets->atlas_page_count); ++page_index)
+    {
+        budget_left = upload_decoded_slot(assets, commands, &assets->atlas_pages[page_index], &upload_bytes);
+    }
+    for (u32 bitmap_index = 1; budget_left && (bitmap_index < BitmapId_Count); ++bitmap_index)
+    {
+        budget_left = upload_decoded_slot(assets, commands, &assets->bitmaps[bitmap_index], &upload_bytes);
+    }
+
+    if (upload_bytes > assets->max_upload_bytes_in_a_frame)
+    {
+        assets->max_upload_bytes_in_a_frame = upload_bytes;
+    }
+}
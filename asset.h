@@ -0,0 +1,121 @@
+#pragma once
+
+/*
+
+NOTE(Nader): Textures are streamed in the background, nothing the frame does ever waits
+on the disk or on a decode:
+
+    1. load_bitmap (main thread) takes a free AssetTask, a slice of transient storage
+       with its own arena, and puts a job on the low priority queue.
+    2. The job (any worker) finds the bitmap already decoded in the asset pack (see
+       asset_pack.h), or reads its file and decodes the PNG/JPEG into the task's arena,
+       then flips the bitmap to AssetState_Decoded.
+    3. upload_decoded_bitmaps (main thread, once a frame) copies decoded bitmaps into
+       asset storage and hands them to the backend as RenderTextureUploads, a band of
+       rows at a time, then gives their tasks back. No more than
+       ASSET_UPLOAD_BYTES_PER_FRAME goes out in a frame, so a level's worth of textures
+       arriving at once, or one huge one, is spread over several frames instead of
+       landing in one.
+
+A bitmap the pack put on an atlas page (see asset_pack.h) doesn't load on its own: its
+page goes through the steps above as one more slot, and the bitmap is that page's
+texture with a uv_rect picking out its region. Bitmaps sharing a page share a texture,
+so drawing them doesn't break a batch.
+
+Until a bitmap is AssetState_Loaded, get_bitmap returns 0 and the caller draws without
+it. A level transition should load_bitmap everything the next level needs ahead of
+time, it costs the frame nothing.
+
+Pixels are 0xAARRGGBB with alpha premultiplied, row 0 at the bottom, same as the
+software framebuffer.
+
+Memory is fixed at startup. A task's arena only has to hold one bitmap's decode, so
+initialize_assets sizes them from the largest bitmap in the pack (see
+get_asset_task_arena_size). A bitmap bigger than that, which can only be a loose file
+the pack doesn't have, fails to load. Bitmaps in the pack are drawn straight out of
+it, so storage only ever holds loose files.
+
+TODO(Nader): Evict slots that haven't been drawn for a while once a game has more
+loose bitmaps than fit in storage. The backends need a way to free a texture handle
+first.
+
+*/
+
+#define ASSET_TASK_COUNT 4
+// NOTE(Nader): A decode took at most 4x its pixels (file, stb_image's scratch and the pixels, incompressible RGBA PNG), plus margin.
+#define ASSET_TASK_ARENA_PIXEL_FACTOR 5
+// NOTE(Nader): The work itself and small bitmaps.
+#define ASSET_MIN_TASK_ARENA_SIZE kilobytes(64)
+// NOTE(Nader): Without a pack nothing says how big the bitmaps are.
+#define ASSET_LOOSE_TASK_ARENA_SIZE megabytes(64)
+#define ASSET_STORAGE_SIZE megabytes(128)
+#define ASSET_UPLOAD_BYTES_PER_FRAME megabytes(2)
+#define ASSET_MAX_ATLAS_PAGES 16
+
+typedef enum BitmapId
+{
+    BitmapId_None,
+    BitmapId_Player,
+
+    BitmapId_Count,
+} BitmapId;
+
+typedef enum AssetState
+{
+    AssetState_Unloaded,
+    AssetState_Queued,
+    AssetState_Decoded,
+    AssetState_Loaded,
+    AssetState_Failed,
+} AssetState;
+
+typedef struct LoadedBitmap
+{
+    u32 width;
+    u32 height;
+    u32 *pixels;
+    // NOTE(Nader): What goes in the texture bits of a sort key, never 0.
+    u32 texture_handle;
+    // NOTE(Nader): (min u, min v, width, height) of the bitmap in its texture, (0, 0, 1, 1) unless it's on an atlas page.
+    v4 uv_rect;
+} LoadedBitmap;
+
+typedef struct AssetTask
+{
+    b32 is_in_use;
+    MemoryArena arena;
+} AssetTask;
+
+typedef struct AssetSlot
+{
+    // NOTE(Nader): A worker moves it from Queued to Decoded or Failed, everything else is the main thread.
+    u32 volatile state;
+    AssetTask *task;
+    LoadedBitmap bitmap;
+    char *filepath;
+    // NOTE(Nader): Set for a bitmap on an atlas page, it stays Queued until the page is Loaded.
+    struct AssetSlot *page;
+
+    // NOTE(Nader): While Decoded, the task's (or the asset pack's) copy of the pixels and
+    // how many rows of them have gone to the backend.
+    u32 *decoded_pixels;
+    b32 decoded_pixels_are_in_pack;
+    u32 uploaded_row_count;
+} AssetSlot;
+
+typedef struct Assets
+{
+    // NOTE(Nader): Pixels of bitmaps that made it to the backend, bar the ones used in place out of the pack.
+    MemoryArena storage;
+    u64 task_arena_size;
+    AssetTask tasks[ASSET_TASK_COUNT];
+    AssetSlot bitmaps[BitmapId_Count];
+    u32 atlas_page_count;
+    AssetSlot atlas_pages[ASSET_MAX_ATLAS_PAGES];
+    u32 next_texture_handle;
+
+    // NOTE(Nader): Stats, for the platform's report.
+    u32 loaded_count;
+    u32 failed_count;
+    u32 max_upload_bytes_in_a_frame;
+} Assets;
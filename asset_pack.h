@@ -0,0 +1,183 @@
+#pragma once
+
+#include <string.h>
+
+/*
+
+NOTE(Nader): The asset pack (blowback.pack), one file holding everything the game loads,
+built offline by asset_packer.c:
+
+    AssetPackHeader
+    AssetPackEntry[entry_count]   sorted by name_hash
+    data                          every entry's data, ASSET_PACK_DATA_ALIGNMENT aligned
+
+The platform maps the whole file read only at startup and never reads it, so startup
+costs the same however many assets there are; pages come in from disk the first time
+something touches them. Lookups are a binary search on the hash of the asset's name (its
+path relative to the repo, with forward slashes, e.g. "data/player.png"), and the data
+is used in place out of the mapping, nothing gets copied out.
+
+Entry data by type:
+
+    Bitmap      - width*height u32s, already decoded to what the game uses at runtime
+                  (premultiplied 0xAARRGGBB, row 0 at the bottom, see
+                  convert_rgba_to_premultiplied_argb)
+    AtlasRegion - an AssetPackAtlasRegion, width and height are the region's
+    Text        - the file's bytes with a null terminator after them, size counts it
+    Blob        - the file's bytes
+
+The packer puts images onto shared atlas pages (Bitmaps named "atlas/page_N") wherever
+they fit, so most images are an AtlasRegion under their own name pointing at a rectangle
+of a page. Everything drawn from one page is one texture, and so one batch.
+
+*/
+
+#define ASSET_PACK_MAGIC (((u32)'B' << 0) | ((u32)'B' << 8) | ((u32)'P' << 16) | ((u32)'K' << 24))
+#define ASSET_PACK_VERSION 2
+#define ASSET_PACK_DATA_ALIGNMENT 64
+#define ASSET_PACK_MAX_NAME_LENGTH 64
+
+typedef enum AssetPackEntryType
+{
+    AssetPackEntryType_Blob,
+    AssetPackEntryType_Text,
+    AssetPackEntryType_Bitmap,
+    AssetPackEntryType_AtlasRegion,
+} AssetPackEntryType;
+
+typedef struct AssetPackHeader
+{
+    u32 magic;
+    u32 version;
+    u32 entry_count;
+    u32 reserved;
+} AssetPackHeader;
+
+typedef struct AssetPackEntry
+{
+    u64 name_hash;
+    char name[ASSET_PACK_MAX_NAME_LENGTH];
+    u32 type;
+    u32 width;
+    u32 height;
+    u32 reserved;
+    // NOTE(Nader): From the start of the file.
+    u64 data_offset;
+    u64 data_size;
+} AssetPackEntry;
+
+// NOTE(Nader): In texels of the page, y counting up from its bottom row.
+typedef struct AssetPackAtlasRegion
+{
+    char page_name[ASSET_PACK_MAX_NAME_LENGTH];
+    u32 x;
+    u32 y;
+    u32 width;
+    u32 height;
+} AssetPackAtlasRegion;
+
+// NOTE(Nader): A mapped pack. Filled in by the platform, base is 0 when there isn't one.
+typedef struct AssetPack
+{
+    u8 *base;
+    u64 size;
+    u32 entry_count;
+    AssetPackEntry *entries;
+} AssetPack;
+
+// NOTE(Nader): FNV-1a.
+internal u64
+asset_pack_hash_name(char *name)
+{
+    u64 result = 14695981039346656037ULL;
+    for (char *scan = name; *scan; ++scan)
+    {
+        result ^= (u8)*scan;
+        result *= 1099511628211ULL;
+    }
+    return(result);
+}
+
+// NOTE(Nader): Checks the header and the entry table fit, pack has to have base and size set.
+internal b32
+open_asset_pack(AssetPack *pack)
+{
+    b32 result = false;
+    AssetPackHeader *header = (AssetPackHeader *)pack->base;
+    if (pack->base && (pack->size >= sizeof(AssetPackHeader)) &&
+        (header->magic == ASSET_PACK_MAGIC) && (header->version == ASSET_PACK_VERSION) &&
+        ((pack->size - sizeof(AssetPackHeader)) / sizeof(AssetPackEntry) >= header->entry_count))
+    {
+        pack->entry_count = header->entry_count;
+        pack->entries = (AssetPackEntry *)(header + 1);
+        result = true;
+    }
+    else
+    {
+        pack->entry_count = 0;
+        pack->entries = 0;
+    }
+    return(result);
+}
+
+// NOTE(Nader): 0 if there's no pack, no such asset, or its data would run past the end of the file.
+internal AssetPackEntry *
+find_asset_pack_entry(AssetPack *pack, char *name)
+{
+    AssetPackEntry *result = 0;
+    if (pack && pack->entry_count)
+    {
+        u64 name_hash = asset_pack_hash_name(name);
+        u32 first = 0;
+        u32 one_past_last = pack->entry_count;
+        while (first < one_past_last)
+        {
+            u32 middle = first + (one_past_last - first) / 2;
+            if (pack->entries[middle].name_hash < name_hash)
+            {
+                first = middle + 1;
+            }
+            else
+            {
+                one_past_last = middle;
+            }
+        }
+
+        for (u32 entry_index = first;
+             (entry_index < pack->entry_count) && (pack->entries[entry_index].name_hash == name_hash);
+             ++entry_index)
+        {
+            AssetPackEntry *entry = &pack->entries[entry_index];
+            if ((strncmp(entry->name, name, sizeof(entry->name)) == 0) &&
+                (entry->data_offset <= pack->size) && (entry->data_size <= (pack->size - entry->data_offset)))
+            {
+                result = entry;
+                break;
+            }
+        }
+    }
+    return(result);
+}
+
+internal void *
+get_asset_pack_data(AssetPack *pack, AssetPackEntry *entry)
+{
+    void *result = pack->base + entry->data_offset;
+    return(result);
+}
+
+// NOTE(Nader): In place, stb_image's RGBA bytes to premultiplied 0xAARRGGBB. The packer and the runtime decode both use this.
+internal void
+convert_rgba_to_premultiplied_argb(u8 *rgba, u32 pixel_count)
+{
+    u32 *pixels = (u32 *)rgba;
+    for (u32 pixel_index = 0; pixel_index < pixel_count; ++pixel_index)
+    {
+        u8 *texel = rgba + 4*pixel_index;
+        u32 alpha = texel[3];
+        u32 r = (texel[0]*alpha + 127) / 255;
+        u32 g = (texel[1]*alpha + 127) / 255;
+        u32 b = (texel[2]*alpha + 127) / 255;
+        pixels[pixel_index] = (alpha << 24) | (r << 16) | (g << 8) | (b << 0);
+    }
+}
@@ -0,0 +1,472 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include "platform.h"
+#include "asset_pack.h"
+
+/*
+
+NOTE(Nader): Offline tool, builds the asset pack (see asset_pack.h) out of loose files:
+
+	asset_packer <pack> <file>...
+
+Each file's name in the pack is the path it was given by, with forward slashes, so run it
+from the repo root. What it becomes depends on its extension:
+
+	.png .jpg .jpeg   Bitmap, decoded here once so the game never has to
+	.vert .frag .txt  Text
+	anything else     Blob (level data and the like)
+
+Then every bitmap small enough goes onto an atlas page, see packer_build_atlas.
+
+This runs at build time, not in the game, so it just mallocs and exits on any error.
+
+*/
+
+#define PACKER_ATLAS_PAGE_DIM 2048
+// NOTE(Nader): Around every image, filled with copies of its edge texels so filtering never pulls in a neighbour.
+#define PACKER_ATLAS_PADDING 1
+#define PACKER_MAX_ATLAS_PAGES 64
+
+typedef struct PackerInput
+{
+	AssetPackEntry entry;
+	void *data;
+} PackerInput;
+
+/*
+
+NOTE(Nader): Skyline packing. A page keeps the outline of its filled area as a list of
+horizontal segments left to right, and an image goes wherever its top ends up lowest,
+resting on the segments under it. Space under an overhang is lost, which is cheap when
+images go in tallest first.
+
+*/
+typedef struct PackerSkylineNode
+{
+	u32 x;
+	u32 y;
+	u32 width;
+} PackerSkylineNode;
+
+typedef struct PackerAtlasPage
+{
+	u32 node_count;
+	PackerSkylineNode nodes[PACKER_ATLAS_PAGE_DIM];
+	u32 used_height;
+	u32 *pixels;
+} PackerAtlasPage;
+
+// NOTE(Nader): Where a width wide rect resting at node_index would sit, or false if it doesn't fit there.
+internal b32
+packer_skyline_fit(PackerAtlasPage *page, u32 node_index, u32 width, u32 height, u32 *y)
+{
+	b32 result = false;
+	u32 x = page->nodes[node_index].x;
+	if (x + width <= PACKER_ATLAS_PAGE_DIM)
+	{
+		u32 top = 0;
+		u32 width_left = width;
+		for (u32 scan_index = node_index; width_left > 0; ++scan_index)
+		{
+			PackerSkylineNode *node = &page->nodes[scan_index];
+			top = HMM_MAX(top, node->y);
+			width_left -= HMM_MIN(width_left, node->width);
+		}
+		if (top + height <= PACKER_ATLAS_PAGE_DIM)
+		{
+			*y = top;
+			result = true;
+		}
+	}
+	return(result);
+}
+
+internal b32
+packer_skyline_insert(PackerAtlasPage *page, u32 width, u32 height, u32 *out_x, u32 *out_y)
+{
+	u32 best_index = 0;
+	u32 best_top = 0xFFFFFFFF;
+	u32 best_node_width = 0xFFFFFFFF;
+	u32 best_y = 0;
+	for (u32 node_index = 0; node_index < page->node_count; ++node_index)
+	{
+		u32 y;
+		if (packer_skyline_fit(page, node_index, width, height, &y))
+		{
+			u32 node_width = page->nodes[node_index].width;
+			if ((y + height < best_top) || ((y + height == best_top) && (node_width < best_node_width)))
+			{
+				best_index = node_index;
+				best_top = y + height;
+				best_node_width = node_width;
+				best_y = y;
+			}
+		}
+	}
+
+	b32 result = (best_top != 0xFFFFFFFF);
+	if (result)
+	{
+		u32 x = page->nodes[best_index].x;
+		*out_x = x;
+		*out_y = best_y;
+
+		// NOTE(Nader): The new segment goes in at best_index, then whatever it covers is cut back or removed.
+		memmove(&page->nodes[best_index + 1], &page->nodes[best_index],
+				(page->node_count - best_index)*sizeof(PackerSkylineNode));
+		++page->node_count;
+		page->nodes[best_index].x = x;
+		page->nodes[best_index].y = best_y + height;
+		page->nodes[best_index].width = width;
+
+		u32 right = x + width;
+		u32 node_index = best_index + 1;
+		while (node_index < page->node_count)
+		{
+			PackerSkylineNode *node = &page->nodes[node_index];
+			if (node->x >= right)
+			{
+				break;
+			}
+			u32 node_right = node->x + node->width;
+			if (node_right <= right)
+			{
+				memmove(node, node + 1, (page->node_count - node_index - 1)*sizeof(PackerSkylineNode));
+				--page->node_count;
+			}
+			else
+			{
+				node->width = node_right - right;
+				node->x = right;
+				break;
+			}
+		}
+
+		for (u32 merge_index = 0; merge_index + 1 < page->node_count;)
+		{
+			PackerSkylineNode *node = &page->nodes[merge_index];
+			if (node->y == node[1].y)
+			{
+				node->width += node[1].width;
+				memmove(node + 1, node + 2, (page->node_count - merge_index - 2)*sizeof(PackerSkylineNode));
+				--page->node_count;
+			}
+			else
+			{
+				++merge_index;
+			}
+		}
+
+		page->used_height = HMM_MAX(page->used_height, best_y + height);
+	}
+	return(result);
+}
+
+internal int
+packer_compare_heights(const void *a, const void *b)
+{
+	u32 height_a = (*(PackerInput **)a)->entry.height;
+	u32 height_b = (*(PackerInput **)b)->entry.height;
+	int result = (height_a > height_b) ? -1 : ((height_a < height_b) ? 1 : 0);
+	return(result);
+}
+
+/*
+
+NOTE(Nader): Moves every bitmap that fits onto atlas pages, tallest first, opening a new
+page whenever one doesn't fit on any so far. The bitmap's entry becomes an AtlasRegion
+and the pages are added as inputs of their own, cut down to the rows they use. Returns
+the new input count.
+
+*/
+internal u32
+packer_build_atlas(PackerInput *inputs, u32 input_count)
+{
+	u32 padded_max = PACKER_ATLAS_PAGE_DIM - 2*PACKER_ATLAS_PADDING;
+	PackerInput **bitmaps = (PackerInput **)calloc(input_count ? input_count : 1, sizeof(PackerInput *));
+	u32 bitmap_count = 0;
+	for (u32 input_index = 0; input_index < input_count; ++input_index)
+	{
+		AssetPackEntry *entry = &inputs[input_index].entry;
+		if ((entry->type == AssetPackEntryType_Bitmap) && (entry->width <= padded_max) && (entry->height <= padded_max))
+		{
+			bitmaps[bitmap_count++] = &inputs[input_index];
+		}
+	}
+	qsort(bitmaps, bitmap_count, sizeof(PackerInput *), packer_compare_heights);
+
+	PackerAtlasPage *pages = (PackerAtlasPage *)calloc(PACKER_MAX_ATLAS_PAGES, sizeof(PackerAtlasPage));
+	u32 page_count = 0;
+	for (u32 bitmap_index = 0; bitmap_index < bitmap_count; ++bitmap_index)
+	{
+		PackerInput *input = bitmaps[bitmap_index];
+		u32 width = input->entry.width;
+		u32 height = input->entry.height;
+		u32 padded_width = width + 2*PACKER_ATLAS_PADDING;
+		u32 padded_height = height + 2*PACKER_ATLAS_PADDING;
+
+		u32 page_index = 0;
+		u32 x = 0;
+		u32 y = 0;
+		for (; page_index < page_count; ++page_index)
+		{
+			if (packer_skyline_insert(&pages[page_index], padded_width, padded_height, &x, &y))
+			{
+				break;
+			}
+		}
+		if (page_index == page_count)
+		{
+			if (page_count == PACKER_MAX_ATLAS_PAGES)
+			{
+				fprintf(stderr, "%s: more than %d atlas pages, left as its own bitmap \n",
+						input->entry.name, PACKER_MAX_ATLAS_PAGES);
+				continue;
+			}
+			PackerAtlasPage *page = &pages[page_count++];
+			page->node_count = 1;
+			page->nodes[0].x = 0;
+			page->nodes[0].y = 0;
+			page->nodes[0].width = PACKER_ATLAS_PAGE_DIM;
+			page->pixels = (u32 *)calloc(PACKER_ATLAS_PAGE_DIM*PACKER_ATLAS_PAGE_DIM, sizeof(u32));
+			packer_skyline_insert(page, padded_width, padded_height, &x, &y);
+		}
+
+		// NOTE(Nader): Copy with the padding, clamping into the image makes the edges repeat outwards.
+		PackerAtlasPage *page = &pages[page_index];
+		u32 *source = (u32 *)input->data;
+		for (u32 row = 0; row < padded_height; ++row)
+		{
+			i32 source_row = HMM_MIN(HMM_MAX((i32)row - PACKER_ATLAS_PADDING, 0), (i32)height - 1);
+			u32 *dest_row = page->pixels + (y + row)*PACKER_ATLAS_PAGE_DIM + x;
+			for (u32 column = 0; column < padded_width; ++column)
+			{
+				i32 source_column = HMM_MIN(HMM_MAX((i32)column - PACKER_ATLAS_PADDING, 0), (i32)width - 1);
+				dest_row[column] = source[source_row*width + source_column];
+			}
+		}
+		free(input->data);
+
+		AssetPackAtlasRegion *region = (AssetPackAtlasRegion *)calloc(1, sizeof(AssetPackAtlasRegion));
+		snprintf(region->page_name, sizeof(region->page_name), "atlas/page_%u", page_index);
+		region->x = x + PACKER_ATLAS_PADDING;
+		region->y = y + PACKER_ATLAS_PADDING;
+		region->width = width;
+		region->height = height;
+		input->entry.type = AssetPackEntryType_AtlasRegion;
+		input->entry.data_size = sizeof(AssetPackAtlasRegion);
+		input->data = region;
+	}
+
+	for (u32 page_index = 0; page_index < page_count; ++page_index)
+	{
+		PackerAtlasPage *page = &pages[page_index];
+		PackerInput *input = &inputs[input_count++];
+		AssetPackEntry *entry = &input->entry;
+		memset(entry, 0, sizeof(*entry));
+		snprintf(entry->name, sizeof(entry->name), "atlas/page_%u", page_index);
+		entry->name_hash = asset_pack_hash_name(entry->name);
+		entry->type = AssetPackEntryType_Bitmap;
+		entry->width = PACKER_ATLAS_PAGE_DIM;
+		entry->height = page->used_height;
+		entry->data_size = (u64)entry->width*entry->height*sizeof(u32);
+		input->data = page->pixels;
+		printf("atlas/page_%u: %u x %u \n", page_index, entry->width, entry->height);
+	}
+	free(pages);
+	free(bitmaps);
+	return(input_count);
+}
+
+internal b32
+packer_has_extension(char *filepath, char *extension)
+{
+	u64 filepath_length = strlen(filepath);
+	u64 extension_length = strlen(extension);
+	b32 result = ((filepath_length >= extension_length) &&
+				  (strcmp(filepath + filepath_length - extension_length, extension) == 0));
+	return(result);
+}
+
+internal void *
+packer_read_file(char *filepath, u64 *size)
+{
+	void *result = 0;
+	FILE *file = fopen(filepath, "rb");
+	if (file)
+	{
+		fseek(file, 0, SEEK_END);
+		long file_size = ftell(file);
+		fseek(file, 0, SEEK_SET);
+		if (file_size >= 0)
+		{
+			// NOTE(Nader): One extra byte so text can be null terminated in place.
+			result = malloc((size_t)file_size + 1);
+			if (result && (fread(result, 1, (size_t)file_size, file) == (size_t)file_size))
+			{
+				((u8 *)result)[file_size] = 0;
+				*size = (u64)file_size;
+			}
+			else
+			{
+				free(result);
+				result = 0;
+			}
+		}
+		fclose(file);
+	}
+	return(result);
+}
+
+internal int
+packer_compare_inputs(const void *a, const void *b)
+{
+	u64 hash_a = ((PackerInput *)a)->entry.name_hash;
+	u64 hash_b = ((PackerInput *)b)->entry.name_hash;
+	int result = (hash_a < hash_b) ? -1 : ((hash_a > hash_b) ? 1 : 0);
+	return(result);
+}
+
+internal b32
+packer_load_input(PackerInput *input, char *filepath)
+{
+	AssetPackEntry *entry = &input->entry;
+	memset(entry, 0, sizeof(*entry));
+	u64 name_length = strlen(filepath);
+	if (name_length >= sizeof(entry->name))
+	{
+		fprintf(stderr, "%s: name is longer than %d characters \n", filepath, ASSET_PACK_MAX_NAME_LENGTH - 1);
+		return(false);
+	}
+	for (u64 char_index = 0; char_index < name_length; ++char_index)
+	{
+		entry->name[char_index] = (filepath[char_index] == '\\') ? '/' : filepath[char_index];
+	}
+	entry->name_hash = asset_pack_hash_name(entry->name);
+
+	u64 file_size = 0;
+	void *contents = packer_read_file(filepath, &file_size);
+	if (!contents)
+	{
+		fprintf(stderr, "%s: could not read \n", filepath);
+		return(false);
+	}
+
+	if (packer_has_extension(filepath, ".png") || packer_has_extension(filepath, ".jpg") ||
+		packer_has_extension(filepath, ".jpeg"))
+	{
+		int width, height, component_count;
+		u8 *rgba = stbi_load_from_memory((stbi_uc *)contents, (int)file_size, &width, &height, &component_count, 4);
+		free(contents);
+		if (!rgba)
+		{
+			fprintf(stderr, "%s: could not decode, %s \n", filepath, stbi_failure_reason());
+			return(false);
+		}
+		convert_rgba_to_premultiplied_argb(rgba, (u32)width*(u32)height);
+		entry->type = AssetPackEntryType_Bitmap;
+		entry->width = (u32)width;
+		entry->height = (u32)height;
+		entry->data_size = (u64)width*(u64)height*sizeof(u32);
+		input->data = rgba;
+	}
+	else if (packer_has_extension(filepath, ".vert") || packer_has_extension(filepath, ".frag") ||
+			 packer_has_extension(filepath, ".txt"))
+	{
+		entry->type = AssetPackEntryType_Text;
+		entry->data_size = file_size + 1;
+		input->data = contents;
+	}
+	else
+	{
+		entry->type = AssetPackEntryType_Blob;
+		entry->data_size = file_size;
+		input->data = contents;
+	}
+	return(true);
+}
+
+int
+main(int argument_count, char **arguments)
+{
+	if (argument_count < 2)
+	{
+		fprintf(stderr, "usage: %s <pack> <file>... \n", arguments[0]);
+		return(1);
+	}
+
+	char *pack_filepath = arguments[1];
+	u32 input_count = (u32)(argument_count - 2);
+	PackerInput *inputs = (PackerInput *)calloc(input_count + PACKER_MAX_ATLAS_PAGES, sizeof(PackerInput));
+	stbi_set_flip_vertically_on_load(true);
+	for (u32 input_index = 0; input_index < input_count; ++input_index)
+	{
+		if (!packer_load_input(&inputs[input_index], arguments[2 + input_index]))
+		{
+			return(1);
+		}
+	}
+
+	input_count = packer_build_atlas(inputs, input_count);
+
+	// NOTE(Nader): Sorted by hash for the game's binary search, names have to be unique.
+	qsort(inputs, input_count, sizeof(PackerInput), packer_compare_inputs);
+	for (u32 input_index = 1; input_index < input_count; ++input_index)
+	{
+		if (strcmp(inputs[input_index - 1].entry.name, inputs[input_index].entry.name) == 0)
+		{
+			fprintf(stderr, "%s: given twice \n", inputs[input_index].entry.name);
+			return(1);
+		}
+	}
+
+	u64 data_offset = sizeof(AssetPackHeader) + input_count*sizeof(AssetPackEntry);
+	for (u32 input_index = 0; input_index < input_count; ++input_index)
+	{
+		data_offset = align_pow2(data_offset, (u64)ASSET_PACK_DATA_ALIGNMENT);
+		inputs[input_index].entry.data_offset = data_offset;
+		data_offset += inputs[input_index].entry.data_size;
+	}
+
+	FILE *pack_file = fopen(pack_filepath, "wb");
+	if (!pack_file)
+	{
+		fprintf(stderr, "%s: could not open for writing \n", pack_filepath);
+		return(1);
+	}
+
+	AssetPackHeader header = {0};
+	header.magic = ASSET_PACK_MAGIC;
+	header.version = ASSET_PACK_VERSION;
+	header.entry_count = input_count;
+	fwrite(&header, sizeof(header), 1, pack_file);
+	for (u32 input_index = 0; input_index < input_count; ++input_index)
+	{
+		fwrite(&inputs[input_index].entry, sizeof(AssetPackEntry), 1, pack_file);
+	}
+
+	u8 padding[ASSET_PACK_DATA_ALIGNMENT] = {0};
+	u64 written = sizeof(AssetPackHeader) + input_count*sizeof(AssetPackEntry);
+	for (u32 input_index = 0; input_index < input_count; ++input_index)
+	{
+		AssetPackEntry *entry = &inputs[input_index].entry;
+		fwrite(padding, 1, (size_t)(entry->data_offset - written), pack_file);
+		fwrite(inputs[input_index].data, 1, (size_t)entry->data_size, pack_file);
+		written = entry->data_offset + entry->data_size;
+	}
+
+	b32 wrote_pack = (ferror(pack_file) == 0);
+	if ((fclose(pack_file) != 0) || !wrote_pack)
+	{
+		fprintf(stderr, "%s: could not write \n", pack_filepath);
+		return(1);
+	}
+
+	printf("%s: %u assets, %.01f KB \n", pack_filepath, input_count, (f64)written / 1024.0);
+	return(0);
+}
@@ -1,3 +1,59 @@
+#include "platform.h"
+#include "profiler.h"
+#include "memory_arena.h"
+#include "transform2d.h"
+#include "renderer.h"
+#include "simd.h"
+#include "entity.h"
+#include "tilemap.h"
+#include "spatial_hash.h"
+#include "asset_pack.h"
+#include "asset.h"
+#include "camera.h"
+#include "blowback.h"
+
+#include "render_group.c"
+#include "entity.c"
+#include "entity_integrate.c"
+#include "simd_math.c"
+#include "tilemap.c"
+#include "spatial_hash.c"
+#include "asset.c"
+#include "camera.c"
+
+/*
+
+NOTE(Nader): Module globals rather than game memory on purpose: a replay snapshot or a
+reload must never carry a SIMD level over to a machine that doesn't have it.
+
+*/
+global b32 simd_level_is_detected;
+global SimdLevel simd_level;
+
+internal SimdLevel
+get_simd_level(void)
+{
+    if (!simd_level_is_detected)
+    {
+        simd_level = simd_get_level();
+        simd_level_is_detected = true;
+    }
+    return(simd_level);
+}
+
+global v4 sprite_colors[SpriteId_Count] =
+{
+    {0.0f, 0.0f, 0.0f, 0.0f},
+    {0.9f, 0.8f, 0.0f, 1.0f},
+};
+
+// NOTE(Nader): Sprites whose bitmap hasn't streamed in yet are drawn in their color.
+global BitmapId sprite_bitmaps[SpriteId_Count] =
+{
+    BitmapId_None,
+    BitmapId_Player,
+};
+
 /*
 
     TODO(Nader): Services that the platform layer provides to the game.
@@ -7,104 +63,171 @@
 /* 
 
 NOTE(Nader): Services that the game provides to the platform layer
-TODO(Nader): Don't pass in shader_program into the function. 
-TODO(Nader): Three things should be passed in to game_update_and_render:
-    - controller/keyboard input
-    - bitmap buffer to use
+TODO(Nader): Still to be passed in to game_simulate / game_render:
     - sound buffer to use
-    - timing
 
 */
-internal void
-game_update_and_render(GameMemory *memory, GameInput *input, u32 shader_program) 
+internal GameState *
+get_game_state(GameMemory *memory)
 {
     GameState *game_state = (GameState *)memory->permanent_storage;
     // TODO(Nader): Move this initialization into the platform layer
-    // TODO(Nader): Pass in the game_state? 
     if (!memory->is_initialized) {
-        game_state->camera_position = v3(0.0f, 0.0f, 3.0f);
-        game_state->camera_front = v3(0.0f, 0.0f, -1.0f);
-        game_state->up = v3(0.0f, 1.0f, 0.0f);
-
-        game_state->camera_target = v3(0.0f, 0.0f, 0.0f);
-        game_state->camera_direction = HMM_NormV3(
-                                HMM_SubV3(game_state->camera_position, game_state->camera_target));
-        game_state->camera_right = HMM_NormV3(HMM_Cross(game_state->up, game_state->camera_direction));
-        game_state->camera_up = HMM_Cross(game_state->camera_direction, game_state->camera_right);
-
-        game_state->movement_x = 0.0f;
-        game_state->movement_y = 0.0f;
-        game_state->position_x = 0.0f;
-        game_state->position_y = 0.0f;
-
-        game_state->old_time = 0;
-        game_state->new_time = 0;
-        game_state->dt = 0;
+        initialize_arena(&game_state->permanent_arena, "permanent",
+                         memory->permanent_storage_size - sizeof(GameState),
+                         (u8 *)memory->permanent_storage + sizeof(GameState));
+
+        EntityStore *entities = &game_state->entities;
+        initialize_entity_store(entities, &game_state->permanent_arena, GAME_MAX_ENTITIES);
+        game_state->player = add_entity(entities);
+        u32 player_index = get_entity_index(entities, game_state->player);
+        entities->sprite_id[player_index] = SpriteId_Player;
+        entities->flags[player_index] = EntityFlag_Player | EntityFlag_Visible;
+        entities->size_x[player_index] = 100.0f;
+        entities->size_y[player_index] = 100.0f;
+
+        initialize_spatial_hash(&game_state->spatial_hash, &game_state->permanent_arena,
+                                SPATIAL_HASH_CELL_SIZE, GAME_MAX_ENTITIES);
+
+        game_state->dt = 0.0f;
         game_state->fps = 0.0f;
-        game_state->shader_program = shader_program;
-        game_state->window_width = 1280.0f;
-        game_state->window_height = 720.0f;
+        game_state->simulate_step_count = 0;
         memory->is_initialized = true;
     }
+    return(game_state);
+}
+
+GAME_EXPORT
+GAME_SIMULATE(game_simulate)
+{
+    global_profiler = memory->profiler;
+    BEGIN_TIMED_BLOCK(game_simulate);
+
+    GameState *game_state = get_game_state(memory);
+    game_state->dt = input->dt_for_frame;
+    ++game_state->simulate_step_count;
 
-    glUseProgram(game_state->shader_program);
     GameControllerInput *input0 = &input->controllers[0];
-    m4 view = m4_diagonal(1.0f);
-    view = HMM_LookAt_RH(game_state->camera_position, 
-                        HMM_AddV3(game_state->camera_position, game_state->camera_front), 
-                        game_state->camera_up);
-
-    m4 projection = m4_diagonal(1.0f);
-    projection = HMM_Orthographic_RH_NO(0.0f, game_state->window_width, 
-                    0.0f, game_state->window_height, 
-                    -0.1f, 1000.0f);
-
-    u32 view_location = glGetUniformLocation(game_state->shader_program, "view");
-    u32 projection_location = glGetUniformLocation(game_state->shader_program, "projection");
-
-    glUniformMatrix4fv(view_location, 1, GL_FALSE, &view.Elements[0][0]);
-    glUniformMatrix4fv(projection_location, 1, GL_FALSE, &projection.Elements[0][0]);
-
-    v3 scale = v3(50.0f, 50.0f, 0.0f);
-    // adjusting is having bottom left of image be where it is drawn.
-    f32 adjust_x = scale.X;
-    f32 adjust_y = scale.Y;
-    v3 translation = v3(game_state->position_x + adjust_x, 
-                        game_state->position_y + adjust_y, 
-                        0.0f);
 
+    EntityStore *entities = &game_state->entities;
+    u32 player_index = get_entity_index(entities, game_state->player);
+    save_entity_previous_positions(entities);
+
+    f32 player_velocity_x = 0.0f;
+    f32 player_velocity_y = 0.0f;
     if(!input0->is_analog)
     {
         if (input0->right.ended_down) {
-            game_state->position_x += 10.0f;
+            player_velocity_x += PLAYER_SPEED;
         }
 
         if (input0->up.ended_down) {
-            game_state->position_y += 10.0f;
+            player_velocity_y += PLAYER_SPEED;
         } 
 
         if (input0->down.ended_down) {
-            game_state->position_y -= 10.0f;
+            player_velocity_y -= PLAYER_SPEED;
         }
         
         if (input0->left.ended_down) {
-            game_state->position_x -= 10.0f;
+            player_velocity_x -= PLAYER_SPEED;
         }
     }
-   
-    m4 model = HMM_M4D(1.0f);
+    entities->velocity_x[player_index] = player_velocity_x;
+    entities->velocity_y[player_index] = player_velocity_y;
 
-    // Scale
-    model = HMM_Scale(scale);
+    TIMED_BLOCK(integrate_entities)
+    {
+        integrate_entities_on_queue(memory, get_simd_level(), entities, input->dt_for_frame, ENTITY_DRAG);
+    }
 
-    // Translation
-    model.Columns[3].X = translation.X;
-    model.Columns[3].Y = translation.Y;
-    model.Columns[3].Z = 0.0f;
+    TIMED_BLOCK(update_spatial_hash)
+    {
+        spatial_hash_update(&game_state->spatial_hash, entities);
+    }
 
-    u32 model_location = glGetUniformLocation(game_state->shader_program, "model");
-    glUniformMatrix4fv(model_location, 1, GL_FALSE, &model.Elements[0][0]);
+    END_TIMED_BLOCK(game_simulate);
+}
 
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+GAME_EXPORT
+GAME_RENDER(game_render)
+{
+    global_profiler = memory->profiler;
+    BEGIN_TIMED_BLOCK(game_render);
+
+    GameState *game_state = get_game_state(memory);
+    game_state->fps = (seconds_elapsed > 0.0f) ? (1.0f / seconds_elapsed) : 0.0f;
+
+    TransientState *tran_state = (TransientState *)memory->transient_storage;
+    if (!tran_state->is_initialized) {
+        initialize_arena(&tran_state->transient_arena, "transient",
+                         memory->transient_storage_size - sizeof(TransientState),
+                         (u8 *)memory->transient_storage + sizeof(TransientState));
+        sub_arena(&tran_state->frame_arena, &tran_state->transient_arena, "frame", megabytes(256));
+        initialize_tilemap(&tran_state->tilemap, &tran_state->transient_arena, TILE_SIZE, 1);
+        initialize_assets(&tran_state->assets, &tran_state->transient_arena, memory->asset_pack);
+        initialize_camera(&tran_state->camera, v3(0.0f, 0.0f, 3.0f), v3(0.0f, 0.0f, -1.0f), v3(0.0f, 1.0f, 0.0f),
+                          -0.1f, 1000.0f);
+        tran_state->is_initialized = true;
+    }
+    reset_arena(&tran_state->frame_arena);
+
+    EntityStore *entities = &game_state->entities;
+    u32 player_index = get_entity_index(entities, game_state->player);
+
+    // NOTE(Nader): Where everything is drawn this frame, between the last two simulate steps.
+    f32 t = interpolation;
+    f32 player_x = HMM_Lerp(entities->previous_position_x[player_index], t, entities->position_x[player_index]);
+    f32 player_y = HMM_Lerp(entities->previous_position_y[player_index], t, entities->position_y[player_index]);
+
+    f32 window_width = (f32)render_commands->width;
+    f32 window_height = (f32)render_commands->height;
+
+    // NOTE(Nader): Keep the player in the middle of the screen.
+    Camera *camera = &tran_state->camera;
+    v3 camera_position = camera->position;
+    camera_position.X = player_x + 0.5f*entities->size_x[player_index] - 0.5f*window_width;
+    camera_position.Y = player_y + 0.5f*entities->size_y[player_index] - 0.5f*window_height;
+    set_camera_position(camera, camera_position);
+    set_camera_viewport(camera, window_width, window_height);
+    update_camera(camera);
+
+    // NOTE(Nader): The command buffer only lives for this frame.
+    render_commands_begin(render_commands, &tran_state->frame_arena, camera->view_projection);
+    push_clear(render_commands, v4(0.8f, 0.2f, 0.5f, 1.0f));
+    upload_decoded_bitmaps(&tran_state->assets, render_commands);
+
+    push_tilemap(render_commands, &tran_state->tilemap, camera->world_min, camera->world_max,
+                 render_sort_key(RenderLayer_Background, 0, 0));
+
+    // NOTE(Nader): The unit quad is centered and 2 wide, entity positions are the bottom left corner.
+    f32 *draw_x = push_array(&tran_state->frame_arena, entities->count, f32);
+    f32 *draw_y = push_array(&tran_state->frame_arena, entities->count, f32);
+    lerp_arrays(get_simd_level(), draw_x, entities->previous_position_x, entities->position_x, t, entities->count);
+    lerp_arrays(get_simd_level(), draw_y, entities->previous_position_y, entities->position_y, t, entities->count);
+    Transform2D *transforms = push_array(&tran_state->frame_arena, entities->count, Transform2D);
+    transform2d_boxes_batch(transforms, draw_x, draw_y, entities->size_x, entities->size_y, entities->count);
+    for (u32 entity_index = 0; entity_index < entities->count; ++entity_index)
+    {
+        if (entities->flags[entity_index] & EntityFlag_Visible)
+        {
+            u32 layer = (entities->flags[entity_index] & EntityFlag_Player) ? RenderLayer_Player : RenderLayer_World;
+            u32 sprite_id = entities->sprite_id[entity_index];
+            LoadedBitmap *bitmap = get_bitmap(&tran_state->assets, sprite_bitmaps[sprite_id]);
+            if (bitmap)
+            {
+                push_sprite(render_commands, transforms[entity_index], v4(1.0f, 1.0f, 1.0f, 1.0f),
+                            bitmap->uv_rect, render_sort_key(layer, 0, bitmap->texture_handle));
+            }
+            else
+            {
+                load_bitmap(&tran_state->assets, memory, sprite_bitmaps[sprite_id]);
+                push_quad(render_commands, transforms[entity_index], sprite_colors[sprite_id],
+                          render_sort_key(layer, 0, 0));
+            }
+        }
+    }
 
-}
\ No newline at end of file
+    render_commands_end(render_commands);
+    END_TIMED_BLOCK(game_render);
+}
@@ -1,6 +1,40 @@
 #pragma once
 
-internal void game_update_and_render();
+/*
+
+NOTE(Nader): Work queue, a service the platform provides to the game. The platform keeps a
+worker thread per core; entries added to a queue run on any of them in any order, and
+complete_all_work doesn't return until every entry added so far has run, helping out
+with them in the meantime. Entries may add more entries. Only the thread that calls the
+game, and work running on the queue, may add to it (see work_queue.h).
+
+*/
+typedef struct PlatformWorkQueue PlatformWorkQueue;
+
+#define PLATFORM_WORK_QUEUE_CALLBACK(name) void name(PlatformWorkQueue *queue, void *data)
+typedef PLATFORM_WORK_QUEUE_CALLBACK(platform_work_queue_callback);
+
+#define PLATFORM_ADD_ENTRY(name) void name(PlatformWorkQueue *queue, platform_work_queue_callback *callback, void *data)
+typedef PLATFORM_ADD_ENTRY(platform_add_entry);
+
+#define PLATFORM_COMPLETE_ALL_WORK(name) void name(PlatformWorkQueue *queue)
+typedef PLATFORM_COMPLETE_ALL_WORK(platform_complete_all_work);
+
+/*
+
+NOTE(Nader): Reads a whole file into memory pushed onto arena. contents is 0 if the file
+couldn't be read or doesn't fit in what's left of arena. Safe to call from work on a
+queue, as long as no other thread is pushing onto the same arena.
+
+*/
+typedef struct PlatformFileContents
+{
+    u32 size;
+    void *contents;
+} PlatformFileContents;
+
+#define PLATFORM_READ_ENTIRE_FILE(name) PlatformFileContents name(char *filepath, MemoryArena *arena)
+typedef PLATFORM_READ_ENTIRE_FILE(platform_read_entire_file);
 
 typedef struct GameMemory 
 {
@@ -9,35 +43,72 @@ typedef struct GameMemory
     void *permanent_storage;
     u64 transient_storage_size;
     void *transient_storage;
+
+    // NOTE(Nader): Owned by the platform, so the game and the platform record into the same one.
+    Profiler *profiler;
+
+    PlatformWorkQueue *work_queue;
+    u32 work_queue_thread_count;
+    platform_add_entry *platform_add_entry;
+    platform_complete_all_work *platform_complete_all_work;
+
+    // NOTE(Nader): For work that may take several frames (asset loads). It has its own
+    // threads, so the game must never wait on it: complete_all_work on work_queue doesn't
+    // wait for anything on here.
+    PlatformWorkQueue *low_priority_queue;
+
+    platform_read_entire_file *platform_read_entire_file;
+    // NOTE(Nader): Mapped for as long as the process runs. base is 0 if there is no pack, see asset_pack.h.
+    AssetPack *asset_pack;
 } GameMemory;
 
+#define GAME_MAX_ENTITIES (1 << 17)
+// NOTE(Nader): World units per second, and the fraction of velocity lost per second.
+#define PLAYER_SPEED 600.0f
+#define ENTITY_DRAG 2.0f
+
+#define TILE_SIZE 64.0f
+// NOTE(Nader): No entity may be bigger than this, see spatial_hash.h.
+#define SPATIAL_HASH_CELL_SIZE 128.0f
+
 typedef struct GameState 
 {
-    u32 shader_program;
+    // NOTE(Nader): Everything in permanent storage after the GameState itself.
+    MemoryArena permanent_arena;
 
-    v3 camera_position;
-    v3 camera_front;
-    v3 up;
+    // NOTE(Nader): Seconds per simulate step, and render frames per second as of the last render.
+    f32 dt;
+    f32 fps;
+    u64 simulate_step_count;
 
-    v3 camera_target;
-    v3 camera_direction;
-    v3 camera_right;
-    v3 camera_up;
+    EntityStore entities;
+    EntityHandle player;
 
-    f32 movement_x;
-    f32 movement_y;
+    SpatialHash spatial_hash;
+} GameState;
 
-    u32 old_time;
-    u32 new_time;
-    u32 dt;
-    f32 fps;
+/*
 
-    f32 position_x;
-    f32 position_y;
+NOTE(Nader): Lives at the start of transient storage. Nothing in here survives past the
+end of a frame except the arenas themselves and what only rendering uses; frame_arena is
+reset every frame.
 
-    f32 window_width;
-    f32 window_height;
-} GameState;
+game_render only writes here, never to GameState (bar fps), so how many frames get drawn
+between two simulate steps can't change the simulation or a replay's state hash. The
+tilemap is here for that reason: paging chunks in and out follows the camera, and every
+chunk can be generated again from the seed.
+
+*/
+typedef struct TransientState
+{
+    b32 is_initialized;
+    MemoryArena transient_arena;
+    MemoryArena frame_arena;
+
+    Tilemap tilemap;
+    Assets assets;
+    Camera camera;
+} TransientState;
 
 /*
 
@@ -113,4 +184,28 @@ typedef struct GameInput
 	GameControllerInput controllers[4];
 } GameInput;
 
+/*
+
+NOTE(Nader): The game is built as its own shared library (blowback.dll / blowback_game.so)
+and the platform looks these up by name, then looks them up again whenever the library is
+rebuilt. Anything that has to survive a reload lives in GameMemory.
+
+game_simulate advances the world by exactly input->dt_for_frame, which the platform keeps
+fixed at 1 / game_update_hz, and is called zero or more times a frame to keep up with
+the wall clock. Given the same starting memory and the same inputs it always ends in the
+same state, which is what replays rely on.
+
+game_render draws once per displayed frame. interpolation is how far the platform's clock
+is past the last simulate step, in steps, [0, 1), and the frame is drawn that far between
+the previous and the current simulated state. So what's on screen lags the simulation by
+up to a step, and moves smoothly whatever the monitor's rate is. seconds_elapsed is the
+length of the last displayed frame.
+
+*/
+#define GAME_SIMULATE(name) void name(GameMemory *memory, GameInput *input)
+typedef GAME_SIMULATE(game_simulate_function);
+
+#define GAME_RENDER(name) void name(GameMemory *memory, f32 interpolation, f32 seconds_elapsed, RenderCommands *render_commands)
+typedef GAME_RENDER(game_render_function);
+
 
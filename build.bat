@@ -3,4 +3,17 @@
 set common_compiler_flags=-MTd -nologo -Gm- -GR- -EHa- -Od -Oi -WX -W4 -wd4244 -wd4201 -wd4100 -wd4189 -wd4505 -wd4005 -DBLOWBACK_INTERNAL=1 -DBLOWBACK_SLOW=1 -FC -Z7
 set common_linker_flags=-incremental:no -opt:ref user32.lib gdi32.lib winmm.lib opengl32.lib /SUBSYSTEM:WINDOWS
 
-cl %common_compiler_flags% "win32_blowback.c" /link %common_linker_flags%
\ No newline at end of file
+REM NOTE: The game is its own DLL so the platform can reload it while running. The platform
+REM won't load it while lock.tmp exists, and the PDB gets a new name every build because the
+REM debugger keeps the old one locked.
+del blowback_*.pdb > NUL 2> NUL
+echo WAITING FOR PDB > lock.tmp
+cl %common_compiler_flags% "blowback.c" -LD /link -incremental:no -opt:ref -PDB:blowback_%random%.pdb
+del lock.tmp
+cl %common_compiler_flags% "win32_blowback.c" /link %common_linker_flags%
+
+REM NOTE: Offline asset packer, then the pack itself (see asset_pack.h). Bitmaps come from data\ if there is one.
+cl %common_compiler_flags% -D_CRT_SECURE_NO_WARNINGS "asset_packer.c" /link -incremental:no -opt:ref
+set pack_inputs=vertex_shader.vert fragment_shader.frag
+if exist data for %%f in (data\*) do call set pack_inputs=%%pack_inputs%% "%%f"
+asset_packer.exe blowback.pack %pack_inputs%
@@ -0,0 +1,21 @@
+#!/bin/sh
+
+# NOTE: Headless Linux host, used for profiling and load testing on machines without a GPU.
+# `./build.sh game` only rebuilds the game library, a running host picks it up on its next frame.
+common_compiler_flags="-std=gnu11 -O2 -g -Wall -Wno-unused-function -Wno-unused-variable -Wno-missing-braces -DBLOWBACK_INTERNAL=1 -DBLOWBACK_SLOW=0"
+common_linker_flags="-lm"
+
+# NOTE: The host won't load the library while the lock file exists.
+touch blowback_game.lock
+cc $common_compiler_flags -shared -fPIC blowback.c -o blowback_game.so $common_linker_flags
+build_result=$?
+rm -f blowback_game.lock
+if [ $build_result -ne 0 ] || [ "$1" = "game" ]; then
+    exit $build_result
+fi
+
+cc $common_compiler_flags linux_blowback.c -o blowback_linux $common_linker_flags -ldl -pthread
+
+# NOTE: Offline asset packer, then the pack itself (see asset_pack.h). Bitmaps come from data/ if there is one.
+cc $common_compiler_flags asset_packer.c -o asset_packer $common_linker_flags || exit 1
+./asset_packer blowback.pack vertex_shader.vert fragment_shader.frag $(find data -type f 2>/dev/null | sort)
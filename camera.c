@@ -0,0 +1,86 @@
+internal void
+initialize_camera(Camera *camera, v3 position, v3 front, v3 up, f32 near_z, f32 far_z)
+{
+    camera->position = position;
+    camera->front = front;
+    camera->up = up;
+    camera->viewport_width = 0.0f;
+    camera->viewport_height = 0.0f;
+    camera->near_z = near_z;
+    camera->far_z = far_z;
+    camera->view_is_dirty = true;
+    camera->projection_is_dirty = true;
+    camera->update_count = 0;
+    camera->rebuild_count = 0;
+}
+
+internal void
+set_camera_position(Camera *camera, v3 position)
+{
+    if ((position.X != camera->position.X) || (position.Y != camera->position.Y) ||
+        (position.Z != camera->position.Z))
+    {
+        camera->position = position;
+        camera->view_is_dirty = true;
+    }
+}
+
+internal void
+set_camera_viewport(Camera *camera, f32 width, f32 height)
+{
+    if ((width != camera->viewport_width) || (height != camera->viewport_height))
+    {
+        camera->viewport_width = width;
+        camera->viewport_height = height;
+        camera->projection_is_dirty = true;
+    }
+}
+
+/*
+
+NOTE(Nader): Call after the setters and before anything reads the matrices. The world
+rectangle is the corners of clip space taken back through the inverse view projection.
+
+*/
+internal void
+update_camera(Camera *camera)
+{
+    ++camera->update_count;
+    if (camera->view_is_dirty || camera->projection_is_dirty)
+    {
+        if (camera->view_is_dirty)
+        {
+            camera->view = HMM_LookAt_RH(camera->position, HMM_AddV3(camera->position, camera->front), camera->up);
+            camera->view_is_dirty = false;
+        }
+        if (camera->projection_is_dirty)
+        {
+            camera->projection = HMM_Orthographic_RH_NO(0.0f, camera->viewport_width, 0.0f, camera->viewport_height,
+                                                        camera->near_z, camera->far_z);
+            camera->projection_is_dirty = false;
+        }
+        camera->view_projection = HMM_MulM4(camera->projection, camera->view);
+        camera->inverse_view_projection = HMM_InvGeneralM4(camera->view_projection);
+
+        v4 corners[4] = {{-1.0f, -1.0f, 0.0f, 1.0f}, {1.0f, -1.0f, 0.0f, 1.0f},
+                         {1.0f, 1.0f, 0.0f, 1.0f}, {-1.0f, 1.0f, 0.0f, 1.0f}};
+        for (u32 corner_index = 0; corner_index < array_count(corners); ++corner_index)
+        {
+            v4 world = HMM_MulM4V4(camera->inverse_view_projection, corners[corner_index]);
+            v2 point = v2(world.X / world.W, world.Y / world.W);
+            if (corner_index == 0)
+            {
+                camera->world_min = point;
+                camera->world_max = point;
+            }
+            else
+            {
+                camera->world_min.X = HMM_MIN(camera->world_min.X, point.X);
+                camera->world_min.Y = HMM_MIN(camera->world_min.Y, point.Y);
+                camera->world_max.X = HMM_MAX(camera->world_max.X, point.X);
+                camera->world_max.Y = HMM_MAX(camera->world_max.Y, point.Y);
+            }
+        }
+        ++camera->rebuild_count;
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+/*
+
+NOTE(Nader): The camera the game draws through. It keeps its view, projection and the
+premultiplied view projection (plus the inverse, and the world rectangle it sees) built,
+and update_camera only rebuilds them when a setter actually changed something: the view
+when the position does, the projection when the viewport does. A camera that stays put
+costs nothing per frame, and the backend gets the one matrix it multiplies by.
+
+Only for the orthographic projection the game uses, (0, 0) is the bottom left corner of
+the viewport.
+
+*/
+
+typedef struct Camera
+{
+    v3 position;
+    v3 front;
+    v3 up;
+    f32 viewport_width;
+    f32 viewport_height;
+    f32 near_z;
+    f32 far_z;
+
+    b32 view_is_dirty;
+    b32 projection_is_dirty;
+    m4 view;
+    m4 projection;
+    m4 view_projection;
+    m4 inverse_view_projection;
+    // NOTE(Nader): What the camera sees of the z = 0 plane, in world space.
+    v2 world_min;
+    v2 world_max;
+
+    // NOTE(Nader): Stats, for the platform's report.
+    u32 update_count;
+    u32 rebuild_count;
+} Camera;
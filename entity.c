@@ -0,0 +1,147 @@
+/*
+
+NOTE(Nader): EntityStore operations, see entity.h for the layout.
+
+*/
+
+#define push_entity_array(arena, count, type) \
+    (type *)push_size_aligned(arena, (count)*sizeof(type), ENTITY_ARRAY_ALIGNMENT)
+
+internal void
+initialize_entity_store(EntityStore *store, MemoryArena *arena, u32 max_count)
+{
+    store->max_count = max_count;
+    store->count = 0;
+
+    store->position_x = push_entity_array(arena, max_count, f32);
+    store->position_y = push_entity_array(arena, max_count, f32);
+    store->size_x = push_entity_array(arena, max_count, f32);
+    store->size_y = push_entity_array(arena, max_count, f32);
+    store->previous_position_x = push_entity_array(arena, max_count, f32);
+    store->previous_position_y = push_entity_array(arena, max_count, f32);
+    store->velocity_x = push_entity_array(arena, max_count, f32);
+    store->velocity_y = push_entity_array(arena, max_count, f32);
+    store->sprite_id = push_entity_array(arena, max_count, u32);
+    store->flags = push_entity_array(arena, max_count, u32);
+    store->dense_to_slot = push_entity_array(arena, max_count, u32);
+
+    store->slot_count = 0;
+    store->first_free_slot = ENTITY_INDEX_NONE;
+    store->slot_to_dense = push_entity_array(arena, max_count, u32);
+    store->slot_generation = push_entity_array(arena, max_count, u32);
+}
+
+// NOTE(Nader): Returns the entity's current index into the component arrays, or ENTITY_INDEX_NONE.
+internal u32
+get_entity_index(EntityStore *store, EntityHandle handle)
+{
+    u32 result = ENTITY_INDEX_NONE;
+    if ((handle.generation != 0) &&
+        (handle.slot < store->slot_count) &&
+        (store->slot_generation[handle.slot] == handle.generation))
+    {
+        result = store->slot_to_dense[handle.slot];
+    }
+    return(result);
+}
+
+internal b32
+is_entity_handle_valid(EntityStore *store, EntityHandle handle)
+{
+    b32 result = (get_entity_index(store, handle) != ENTITY_INDEX_NONE);
+    return(result);
+}
+
+// NOTE(Nader): New entities start out with every component zeroed. Returns the null handle when full.
+internal EntityHandle
+add_entity(EntityStore *store)
+{
+    EntityHandle result = {0};
+    if (store->count < store->max_count)
+    {
+        u32 slot;
+        if (store->first_free_slot != ENTITY_INDEX_NONE)
+        {
+            slot = store->first_free_slot;
+            store->first_free_slot = store->slot_to_dense[slot];
+        }
+        else
+        {
+            slot = store->slot_count++;
+            store->slot_generation[slot] = 1;
+        }
+
+        u32 index = store->count++;
+        store->slot_to_dense[slot] = index;
+        store->dense_to_slot[index] = slot;
+
+        store->position_x[index] = 0.0f;
+        store->position_y[index] = 0.0f;
+        store->size_x[index] = 0.0f;
+        store->size_y[index] = 0.0f;
+        store->previous_position_x[index] = 0.0f;
+        store->previous_position_y[index] = 0.0f;
+        store->velocity_x[index] = 0.0f;
+        store->velocity_y[index] = 0.0f;
+        store->sprite_id[index] = SpriteId_None;
+        store->flags[index] = 0;
+
+        result.slot = slot;
+        result.generation = store->slot_generation[slot];
+    }
+    else
+    {
+        asserts(!"Entity store is full");
+    }
+    return(result);
+}
+
+// NOTE(Nader): Moves the last entity into the removed one's place. Returns false for stale handles.
+internal b32
+remove_entity(EntityStore *store, EntityHandle handle)
+{
+    u32 index = get_entity_index(store, handle);
+    if (index == ENTITY_INDEX_NONE)
+    {
+        return(false);
+    }
+
+    u32 last_index = --store->count;
+    if (index != last_index)
+    {
+        store->position_x[index] = store->position_x[last_index];
+        store->position_y[index] = store->position_y[last_index];
+        store->size_x[index] = store->size_x[last_index];
+        store->size_y[index] = store->size_y[last_index];
+        store->previous_position_x[index] = store->previous_position_x[last_index];
+        store->previous_position_y[index] = store->previous_position_y[last_index];
+        store->velocity_x[index] = store->velocity_x[last_index];
+        store->velocity_y[index] = store->velocity_y[last_index];
+        store->sprite_id[index] = store->sprite_id[last_index];
+        store->flags[index] = store->flags[last_index];
+
+        u32 moved_slot = store->dense_to_slot[last_index];
+        store->dense_to_slot[index] = moved_slot;
+        store->slot_to_dense[moved_slot] = index;
+    }
+
+    u32 slot = handle.slot;
+    if (++store->slot_generation[slot] == 0)
+    {
+        store->slot_generation[slot] = 1;
+    }
+    store->slot_to_dense[slot] = store->first_free_slot;
+    store->first_free_slot = slot;
+    return(true);
+}
+
+// NOTE(Nader): Called at the start of every simulate step, see previous_position in entity.h.
+internal void
+save_entity_previous_positions(EntityStore *store)
+{
+    for (u32 index = 0; index < store->count; ++index)
+    {
+        store->previous_position_x[index] = store->position_x[index];
+        store->previous_position_y[index] = store->position_y[index];
+    }
+}
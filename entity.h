@@ -0,0 +1,69 @@
+#pragma once
+
+/*
+
+NOTE(Nader): Entities are stored as structure of arrays. Every component is its own
+array and the live entities are packed at the front of all of them, so a system that
+only needs positions and velocities streams through exactly those arrays and nothing else.
+
+Removing an entity moves the last one into its place (swap remove), so the arrays never
+have holes and entity order is not stable. Code outside the update loops refers to
+entities by EntityHandle instead of by index: a handle names a slot, the slot knows
+where its entity currently lives in the dense arrays, and the slot's generation goes up
+every time its entity is removed so stale handles stop resolving.
+
+*/
+
+typedef struct EntityHandle
+{
+    u32 slot;
+    // NOTE(Nader): 0 is never a live generation, so a zeroed handle is the null handle.
+    u32 generation;
+} EntityHandle;
+
+typedef enum EntityFlag
+{
+    EntityFlag_Player = (1 << 0),
+    EntityFlag_Visible = (1 << 1),
+} EntityFlag;
+
+typedef enum SpriteId
+{
+    SpriteId_None,
+    SpriteId_Player,
+
+    SpriteId_Count,
+} SpriteId;
+
+#define ENTITY_INDEX_NONE 0xFFFFFFFF
+// NOTE(Nader): Component arrays are cache line aligned so SIMD loops can use aligned loads.
+#define ENTITY_ARRAY_ALIGNMENT 64
+
+typedef struct EntityStore
+{
+    u32 max_count;
+    u32 count;
+
+    // NOTE(Nader): Dense components, [0, count) are live. position is the bottom left
+    // corner of the entity's bounding box, size its width and height.
+    f32 *position_x;
+    f32 *position_y;
+    f32 *size_x;
+    f32 *size_y;
+    // NOTE(Nader): Where position was before the current simulate step, for drawing in between
+    // steps. Anything that puts an entity somewhere other than by moving it (spawning,
+    // teleporting) should set this too, or it is drawn sliding over from the old spot.
+    f32 *previous_position_x;
+    f32 *previous_position_y;
+    f32 *velocity_x;
+    f32 *velocity_y;
+    u32 *sprite_id;
+    u32 *flags;
+    u32 *dense_to_slot;
+
+    // NOTE(Nader): Handle slots. A free slot's slot_to_dense is the next free slot.
+    u32 slot_count;
+    u32 first_free_slot;
+    u32 *slot_to_dense;
+    u32 *slot_generation;
+} EntityStore;
@@ -0,0 +1,206 @@
+/*
+
+NOTE(Nader): Movement integration for every entity. Each kernel does, per entity,
+
+    position += velocity*dt
+    velocity *= velocity_scale
+
+straight over the SoA arrays in EntityStore, with one variant per SimdLevel. The wide
+kernels run their aligned body and hand the tail to the scalar kernel. All of them give
+the same bits (see simd.h).
+
+*/
+
+internal void
+integrate_entities_scalar(f32 *position_x, f32 *position_y, f32 *velocity_x, f32 *velocity_y,
+                          u32 first, u32 count, f32 dt, f32 velocity_scale)
+{
+    for (u32 index = first; index < count; ++index)
+    {
+        position_x[index] = position_x[index] + velocity_x[index]*dt;
+        position_y[index] = position_y[index] + velocity_y[index]*dt;
+        velocity_x[index] = velocity_x[index]*velocity_scale;
+        velocity_y[index] = velocity_y[index]*velocity_scale;
+    }
+}
+
+#if SIMD_X86
+internal void
+integrate_entities_sse2(f32 *position_x, f32 *position_y, f32 *velocity_x, f32 *velocity_y,
+                        u32 count, f32 dt, f32 velocity_scale)
+{
+    __m128 dt_4x = _mm_set1_ps(dt);
+    __m128 velocity_scale_4x = _mm_set1_ps(velocity_scale);
+    u32 wide_count = count & ~3u;
+    for (u32 index = 0; index < wide_count; index += 4)
+    {
+        __m128 vx = _mm_load_ps(velocity_x + index);
+        __m128 vy = _mm_load_ps(velocity_y + index);
+        _mm_store_ps(position_x + index, _mm_add_ps(_mm_load_ps(position_x + index), _mm_mul_ps(vx, dt_4x)));
+        _mm_store_ps(position_y + index, _mm_add_ps(_mm_load_ps(position_y + index), _mm_mul_ps(vy, dt_4x)));
+        _mm_store_ps(velocity_x + index, _mm_mul_ps(vx, velocity_scale_4x));
+        _mm_store_ps(velocity_y + index, _mm_mul_ps(vy, velocity_scale_4x));
+    }
+    integrate_entities_scalar(position_x, position_y, velocity_x, velocity_y, wide_count, count, dt, velocity_scale);
+}
+
+SIMD_TARGET_AVX2 internal void
+integrate_entities_avx2(f32 *position_x, f32 *position_y, f32 *velocity_x, f32 *velocity_y,
+                        u32 count, f32 dt, f32 velocity_scale)
+{
+    __m256 dt_8x = _mm256_set1_ps(dt);
+    __m256 velocity_scale_8x = _mm256_set1_ps(velocity_scale);
+    u32 wide_count = count & ~7u;
+    for (u32 index = 0; index < wide_count; index += 8)
+    {
+        __m256 vx = _mm256_load_ps(velocity_x + index);
+        __m256 vy = _mm256_load_ps(velocity_y + index);
+        _mm256_store_ps(position_x + index,
+                        _mm256_add_ps(_mm256_load_ps(position_x + index), _mm256_mul_ps(vx, dt_8x)));
+        _mm256_store_ps(position_y + index,
+                        _mm256_add_ps(_mm256_load_ps(position_y + index), _mm256_mul_ps(vy, dt_8x)));
+        _mm256_store_ps(velocity_x + index, _mm256_mul_ps(vx, velocity_scale_8x));
+        _mm256_store_ps(velocity_y + index, _mm256_mul_ps(vy, velocity_scale_8x));
+    }
+    _mm256_zeroupper();
+    integrate_entities_scalar(position_x, position_y, velocity_x, velocity_y, wide_count, count, dt, velocity_scale);
+}
+#endif
+
+#if SIMD_NEON
+internal void
+integrate_entities_neon(f32 *position_x, f32 *position_y, f32 *velocity_x, f32 *velocity_y,
+                        u32 count, f32 dt, f32 velocity_scale)
+{
+    float32x4_t dt_4x = vdupq_n_f32(dt);
+    float32x4_t velocity_scale_4x = vdupq_n_f32(velocity_scale);
+    u32 wide_count = count & ~3u;
+    for (u32 index = 0; index < wide_count; index += 4)
+    {
+        float32x4_t vx = vld1q_f32(velocity_x + index);
+        float32x4_t vy = vld1q_f32(velocity_y + index);
+        // NOTE(Nader): Separate multiply and add, vfmaq would round differently from the scalar loop.
+        vst1q_f32(position_x + index, vaddq_f32(vld1q_f32(position_x + index), vmulq_f32(vx, dt_4x)));
+        vst1q_f32(position_y + index, vaddq_f32(vld1q_f32(position_y + index), vmulq_f32(vy, dt_4x)));
+        vst1q_f32(velocity_x + index, vmulq_f32(vx, velocity_scale_4x));
+        vst1q_f32(velocity_y + index, vmulq_f32(vy, velocity_scale_4x));
+    }
+    integrate_entities_scalar(position_x, position_y, velocity_x, velocity_y, wide_count, count, dt, velocity_scale);
+}
+#endif
+
+// NOTE(Nader): The arrays must be ENTITY_ARRAY_ALIGNMENT aligned, EntityStore's are.
+internal void
+integrate_entity_arrays(SimdLevel level, f32 *position_x, f32 *position_y, f32 *velocity_x, f32 *velocity_y,
+                        u32 count, f32 dt, f32 velocity_scale)
+{
+    switch (level)
+    {
+#if SIMD_X86
+    case SimdLevel_AVX2:
+    {
+        integrate_entities_avx2(position_x, position_y, velocity_x, velocity_y, count, dt, velocity_scale);
+    } break;
+    case SimdLevel_SSE2:
+    {
+        integrate_entities_sse2(position_x, position_y, velocity_x, velocity_y, count, dt, velocity_scale);
+    } break;
+#endif
+#if SIMD_NEON
+    case SimdLevel_NEON:
+    {
+        integrate_entities_neon(position_x, position_y, velocity_x, velocity_y, count, dt, velocity_scale);
+    } break;
+#endif
+    default:
+    {
+        integrate_entities_scalar(position_x, position_y, velocity_x, velocity_y, 0, count, dt, velocity_scale);
+    } break;
+    }
+}
+
+/*
+
+NOTE(Nader): drag is how much of its velocity an entity loses per second. It is folded
+into one scale for the frame so the kernels only multiply.
+
+*/
+internal void
+integrate_entities(SimdLevel level, EntityStore *store, f32 dt, f32 drag)
+{
+    f32 velocity_scale = 1.0f / (1.0f + drag*dt);
+    integrate_entity_arrays(level, store->position_x, store->position_y, store->velocity_x, store->velocity_y,
+                            store->count, dt, velocity_scale);
+}
+
+/*
+
+NOTE(Nader): integrate_entities split across the work queue. Every entity is independent,
+so each slice runs the same kernel over its own range and the result is the same bits as
+one call. Slices start on a multiple of the array alignment so the wide kernels' aligned
+loads still line up, and are never smaller than INTEGRATE_ENTITIES_MIN_WORK_SIZE, below
+that waking another thread costs more than it saves.
+
+*/
+#define INTEGRATE_ENTITIES_MIN_WORK_SIZE 8192
+#define INTEGRATE_ENTITIES_MAX_WORK_COUNT 256
+
+typedef struct IntegrateEntitiesWork
+{
+    SimdLevel level;
+    EntityStore *store;
+    u32 first;
+    u32 count;
+    f32 dt;
+    f32 velocity_scale;
+} IntegrateEntitiesWork;
+
+internal PLATFORM_WORK_QUEUE_CALLBACK(do_integrate_entities_work)
+{
+    IntegrateEntitiesWork *work = (IntegrateEntitiesWork *)data;
+    EntityStore *store = work->store;
+    u32 first = work->first;
+    integrate_entity_arrays(work->level, store->position_x + first, store->position_y + first,
+                            store->velocity_x + first, store->velocity_y + first,
+                            work->count, work->dt, work->velocity_scale);
+}
+
+internal void
+integrate_entities_on_queue(GameMemory *memory, SimdLevel level, EntityStore *store, f32 dt, f32 drag)
+{
+    // NOTE(Nader): A few slices per thread so a thread that gets held up doesn't hold up the rest.
+    u32 lane_count = ENTITY_ARRAY_ALIGNMENT / sizeof(f32);
+    u32 work_size = store->count / (4*memory->work_queue_thread_count + 1);
+    if (work_size < INTEGRATE_ENTITIES_MIN_WORK_SIZE)
+    {
+        work_size = INTEGRATE_ENTITIES_MIN_WORK_SIZE;
+    }
+    if (work_size < store->count / INTEGRATE_ENTITIES_MAX_WORK_COUNT + 1)
+    {
+        work_size = store->count / INTEGRATE_ENTITIES_MAX_WORK_COUNT + 1;
+    }
+    work_size = align_pow2(work_size, lane_count);
+
+    if ((memory->work_queue_thread_count <= 1) || (store->count <= work_size))
+    {
+        integrate_entities(level, store, dt, drag);
+    }
+    else
+    {
+        IntegrateEntitiesWork works[INTEGRATE_ENTITIES_MAX_WORK_COUNT];
+        u32 work_count = 0;
+        f32 velocity_scale = 1.0f / (1.0f + drag*dt);
+        for (u32 first = 0; first < store->count; first += work_size)
+        {
+            IntegrateEntitiesWork *work = &works[work_count++];
+            work->level = level;
+            work->store = store;
+            work->first = first;
+            work->count = ((store->count - first) < work_size) ? (store->count - first) : work_size;
+            work->dt = dt;
+            work->velocity_scale = velocity_scale;
+            memory->platform_add_entry(memory->work_queue, do_integrate_entities_work, work);
+        }
+        memory->platform_complete_all_work(memory->work_queue);
+    }
+}
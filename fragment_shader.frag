@@ -1,7 +1,14 @@
 #version 330 core
 
+in vec4 vertex_color;
+in vec2 vertex_uv;
+
+// NOTE(Nader): Premultiplied alpha, see renderer_opengl.c.
+uniform sampler2D sprite_texture;
+
 out vec4 FragColor;
 
 void main() {
-	FragColor = vec4(0.9, 0.8, 0.0, 1.0);
-}
\ No newline at end of file
+	vec4 tint = vec4(vertex_color.rgb*vertex_color.a, vertex_color.a);
+	FragColor = texture(sprite_texture, vertex_uv)*tint;
+}
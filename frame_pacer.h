@@ -0,0 +1,119 @@
+#pragma once
+
+/*
+
+NOTE(Nader): Frame pacing shared by the platform layers. The platform owns the clock and
+the OS timer, this file only decides how long to sleep and keeps the stats.
+
+Each frame has an absolute deadline. The platform sleeps on a high resolution timer until
+spin_margin_seconds before it, then spins (with a pause instruction) for the rest. OS
+timers wake up late by a varying amount, so every sleep reports how much it overslept
+and the margin follows a running mean + deviation of that, clamped to
+[FRAME_PACER_MIN_SPIN_MARGIN, FRAME_PACER_MAX_SPIN_MARGIN]. On a quiet machine that ends
+up being a few tens of microseconds of spinning per frame instead of a whole core.
+
+A frame whose work runs past its deadline is a missed frame. We don't try to catch up
+on those, the next deadline is one frame from now.
+
+*/
+
+#define FRAME_PACER_MIN_SPIN_MARGIN 0.000050
+#define FRAME_PACER_MAX_SPIN_MARGIN 0.004000
+// NOTE(Nader): Weight of the newest oversleep in the running estimate.
+#define FRAME_PACER_OVERSLEEP_WEIGHT 0.05
+
+typedef struct FramePacer
+{
+    f64 target_seconds_per_frame;
+
+    f64 oversleep_mean;
+    f64 oversleep_variance;
+    f64 spin_margin_seconds;
+
+    u64 frame_count;
+    u64 missed_frame_count;
+    f64 worst_oversleep_seconds;
+    f64 worst_frame_error_seconds;
+    f64 total_sleep_seconds;
+    f64 total_spin_seconds;
+} FramePacer;
+
+internal void
+frame_pacer_init(FramePacer *pacer, f64 target_seconds_per_frame)
+{
+    memset(pacer, 0, sizeof(*pacer));
+    pacer->target_seconds_per_frame = target_seconds_per_frame;
+    // NOTE(Nader): Start pessimistic, the margin shrinks once we have seen the timer.
+    pacer->oversleep_mean = 0.001;
+    pacer->spin_margin_seconds = FRAME_PACER_MAX_SPIN_MARGIN / 2.0;
+}
+
+// NOTE(Nader): How long to sleep on the OS timer with seconds_remaining left until the deadline.
+internal f64
+frame_pacer_sleep_seconds(FramePacer *pacer, f64 seconds_remaining)
+{
+    f64 result = seconds_remaining - pacer->spin_margin_seconds;
+    if (result < 0.0)
+    {
+        result = 0.0;
+    }
+    return(result);
+}
+
+internal void
+frame_pacer_record_sleep(FramePacer *pacer, f64 requested_seconds, f64 slept_seconds)
+{
+    f64 oversleep = slept_seconds - requested_seconds;
+    if (oversleep > pacer->worst_oversleep_seconds)
+    {
+        pacer->worst_oversleep_seconds = oversleep;
+    }
+    pacer->total_sleep_seconds += slept_seconds;
+
+    f64 delta = oversleep - pacer->oversleep_mean;
+    pacer->oversleep_mean += FRAME_PACER_OVERSLEEP_WEIGHT*delta;
+    pacer->oversleep_variance = (1.0 - FRAME_PACER_OVERSLEEP_WEIGHT)*
+        (pacer->oversleep_variance + FRAME_PACER_OVERSLEEP_WEIGHT*delta*delta);
+
+    f64 margin = pacer->oversleep_mean + 3.0*sqrt(pacer->oversleep_variance);
+    if (margin < FRAME_PACER_MIN_SPIN_MARGIN)
+    {
+        margin = FRAME_PACER_MIN_SPIN_MARGIN;
+    }
+    if (margin > FRAME_PACER_MAX_SPIN_MARGIN)
+    {
+        margin = FRAME_PACER_MAX_SPIN_MARGIN;
+    }
+    pacer->spin_margin_seconds = margin;
+}
+
+internal void
+frame_pacer_record_spin(FramePacer *pacer, f64 spin_seconds)
+{
+    pacer->total_spin_seconds += spin_seconds;
+}
+
+/*
+
+NOTE(Nader): frame_seconds is the full frame, start to start. missed is whether the
+frame's work ran past its deadline. Missed frames don't count towards the error, we
+already know they were late.
+
+*/
+internal void
+frame_pacer_end_frame(FramePacer *pacer, f64 frame_seconds, b32 missed)
+{
+    ++pacer->frame_count;
+    if (missed)
+    {
+        ++pacer->missed_frame_count;
+    }
+    else
+    {
+        f64 error = fabs(frame_seconds - pacer->target_seconds_per_frame);
+        if (error > pacer->worst_frame_error_seconds)
+        {
+            pacer->worst_frame_error_seconds = error;
+        }
+    }
+}
@@ -32,6 +32,8 @@
 
 #define GL_ARRAY_BUFFER                   0x8892 // Acquired from:
 #define GL_ARRAY_BUFFER_BINDING           0x8894 // https://www.opengl.org/registry/api/GL/glext.h
+#define GL_BGRA                           0x80E1
+#define GL_CLAMP_TO_EDGE                  0x812F
 #define GL_COLOR_ATTACHMENT0              0x8CE0
 #define GL_COMPILE_STATUS                 0x8B81
 #define GL_CURRENT_PROGRAM                0x8B8D
@@ -102,6 +104,8 @@ typedef ptrdiff_t GLsizeiptr;
     GLE(void,      BindVertexArray,       GLuint array) \
     GLE(void,      GenerateMipmap,        GLenum target) \
     GLE(void,      DeleteVertexArrays,    GLsizei n, const GLuint* arrays) \
+    GLE(void,      VertexAttribDivisor,   GLuint index, GLuint divisor) \
+    GLE(void,      DrawElementsInstanced, GLenum mode, GLsizei count, GLenum type, const GLvoid *indices, GLsizei instancecount) \
     /* end */
 
 #define GLE(ret, name, ...) typedef ret GLDECL name##proc(__VA_ARGS__); extern name##proc * gl##name;
@@ -0,0 +1,484 @@
+#pragma once
+
+/*
+
+NOTE(Nader): Sits between the GL backend and the driver. Include it right after
+gl_lite.h: from then on every gl* call in PAPAYA_GL_LIST, PAPAYA_GL_LIST_WIN32 and
+GL_STATE_CACHE_GL11_LIST (the GL 1.1 functions opengl32 exports directly) is a macro
+that counts the call against its entry point and then makes it.
+
+The state the backend sets over and over (program, vertex array, buffer, framebuffer
+and texture binds, the active texture unit, blending, viewport and clear color) also
+goes through a copy of what GL currently has, and a call that would set what's already
+set is dropped before it reaches the driver. Those are counted separately, as filtered,
+so the backend code that asks for them can be found and fixed.
+
+gl_state_cache_end_frame moves the counts to last_frame_* once a frame. Only state
+changed through these macros is tracked; anything that changes GL state some other way
+(another library, a new context) has to call gl_state_cache_reset after.
+
+*/
+
+#define GL_STATE_CACHE_GL11_LIST \
+    /* ret, name, params */ \
+    GLE(void,      BindTexture,             GLenum target, GLuint texture) \
+    GLE(void,      BlendFunc,               GLenum sfactor, GLenum dfactor) \
+    GLE(void,      Clear,                   GLbitfield mask) \
+    GLE(void,      ClearColor,              GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha) \
+    GLE(void,      DeleteTextures,          GLsizei n, const GLuint *textures) \
+    GLE(void,      Disable,                 GLenum cap) \
+    GLE(void,      Enable,                  GLenum cap) \
+    GLE(void,      GenTextures,             GLsizei n, GLuint *textures) \
+    GLE(void,      TexImage2D,              GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid *pixels) \
+    GLE(void,      TexParameteri,           GLenum target, GLenum pname, GLint param) \
+    GLE(void,      TexSubImage2D,           GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const GLvoid *pixels) \
+    GLE(void,      Viewport,                GLint x, GLint y, GLsizei width, GLsizei height) \
+    /* end */
+
+typedef enum GLCallId
+{
+#define GLE(ret, name, ...) GLCall_##name,
+    PAPAYA_GL_LIST
+    PAPAYA_GL_LIST_WIN32
+    GL_STATE_CACHE_GL11_LIST
+#undef GLE
+
+    GLCall_Count,
+} GLCallId;
+
+global char *gl_call_names[GLCall_Count] =
+{
+#define GLE(ret, name, ...) #name,
+    PAPAYA_GL_LIST
+    PAPAYA_GL_LIST_WIN32
+    GL_STATE_CACHE_GL11_LIST
+#undef GLE
+};
+
+// NOTE(Nader): A cached value nothing can match, so the next call always goes through.
+#define GL_STATE_UNKNOWN 0xFFFFFFFF
+#define GL_STATE_CACHE_TEXTURE_UNITS 16
+
+typedef struct GLStateCache
+{
+    u32 program;
+    u32 vertex_array;
+    u32 array_buffer;
+    // NOTE(Nader): Part of the vertex array's state, unknown again whenever a different one is bound.
+    u32 element_array_buffer;
+    u32 framebuffer;
+    u32 active_texture_unit;
+    u32 texture_2d[GL_STATE_CACHE_TEXTURE_UNITS];
+    u32 blend;
+    u32 blend_source;
+    u32 blend_dest;
+    b32 viewport_is_known;
+    i32 viewport[4];
+    b32 clear_color_is_known;
+    f32 clear_color[4];
+
+    u32 call_counts[GLCall_Count];
+    u32 filtered_call_counts[GLCall_Count];
+    u32 last_frame_call_counts[GLCall_Count];
+    u32 last_frame_filtered_call_counts[GLCall_Count];
+} GLStateCache;
+
+global GLStateCache gl_state_cache;
+
+#define GL_COUNT_CALL(name) (++gl_state_cache.call_counts[GLCall_##name])
+#define GL_COUNT_FILTERED_CALL(name) (++gl_state_cache.filtered_call_counts[GLCall_##name])
+
+internal void
+gl_state_cache_reset(void)
+{
+    GLStateCache *cache = &gl_state_cache;
+    cache->program = GL_STATE_UNKNOWN;
+    cache->vertex_array = GL_STATE_UNKNOWN;
+    cache->array_buffer = GL_STATE_UNKNOWN;
+    cache->element_array_buffer = GL_STATE_UNKNOWN;
+    cache->framebuffer = GL_STATE_UNKNOWN;
+    cache->active_texture_unit = GL_STATE_UNKNOWN;
+    for (u32 unit_index = 0; unit_index < GL_STATE_CACHE_TEXTURE_UNITS; ++unit_index)
+    {
+        cache->texture_2d[unit_index] = GL_STATE_UNKNOWN;
+    }
+    cache->blend = GL_STATE_UNKNOWN;
+    cache->blend_source = GL_STATE_UNKNOWN;
+    cache->blend_dest = GL_STATE_UNKNOWN;
+    cache->viewport_is_known = false;
+    cache->clear_color_is_known = false;
+}
+
+internal void
+gl_state_cache_end_frame(void)
+{
+    GLStateCache *cache = &gl_state_cache;
+    for (u32 call_index = 0; call_index < GLCall_Count; ++call_index)
+    {
+        cache->last_frame_call_counts[call_index] = cache->call_counts[call_index];
+        cache->last_frame_filtered_call_counts[call_index] = cache->filtered_call_counts[call_index];
+        cache->call_counts[call_index] = 0;
+        cache->filtered_call_counts[call_index] = 0;
+    }
+}
+
+// NOTE(Nader): Last frame's totals, then every entry point it called, same shape as profiler_format_summary.
+internal u32
+gl_state_cache_format_counts(char *dest, u32 dest_size)
+{
+    GLStateCache *cache = &gl_state_cache;
+    u32 call_count = 0;
+    u32 filtered_call_count = 0;
+    for (u32 call_index = 0; call_index < GLCall_Count; ++call_index)
+    {
+        call_count += cache->last_frame_call_counts[call_index];
+        filtered_call_count += cache->last_frame_filtered_call_counts[call_index];
+    }
+
+    u32 used = 0;
+    int length = snprintf(dest, dest_size, "gl calls last frame: %u | filtered as redundant: %u \n",
+                          call_count, filtered_call_count);
+    if (length > 0)
+    {
+        used += (u32)length;
+    }
+    for (u32 call_index = 0; (call_index < GLCall_Count) && (used < dest_size); ++call_index)
+    {
+        u32 calls = cache->last_frame_call_counts[call_index];
+        u32 filtered_calls = cache->last_frame_filtered_call_counts[call_index];
+        if (calls || filtered_calls)
+        {
+            length = snprintf(dest + used, dest_size - used, "gl%-24s calls: %6u | filtered: %6u \n",
+                              gl_call_names[call_index], calls, filtered_calls);
+            if (length < 0)
+            {
+                break;
+            }
+            used += (u32)length;
+        }
+    }
+    if (used >= dest_size)
+    {
+        used = dest_size - 1;
+    }
+    return(used);
+}
+
+// NOTE(Nader): The cached entry points. They call GL directly, so they have to come before the macros below.
+internal void
+gl_cached_use_program(GLuint program)
+{
+    if (gl_state_cache.program != program)
+    {
+        GL_COUNT_CALL(UseProgram);
+        glUseProgram(program);
+        gl_state_cache.program = program;
+    }
+    else
+    {
+        GL_COUNT_FILTERED_CALL(UseProgram);
+    }
+}
+
+internal void
+gl_cached_bind_vertex_array(GLuint array)
+{
+    if (gl_state_cache.vertex_array != array)
+    {
+        GL_COUNT_CALL(BindVertexArray);
+        glBindVertexArray(array);
+        gl_state_cache.vertex_array = array;
+        gl_state_cache.element_array_buffer = GL_STATE_UNKNOWN;
+    }
+    else
+    {
+        GL_COUNT_FILTERED_CALL(BindVertexArray);
+    }
+}
+
+internal void
+gl_cached_bind_buffer(GLenum target, GLuint buffer)
+{
+    u32 *cached = 0;
+    if (target == GL_ARRAY_BUFFER)
+    {
+        cached = &gl_state_cache.array_buffer;
+    }
+    else if (target == GL_ELEMENT_ARRAY_BUFFER)
+    {
+        cached = &gl_state_cache.element_array_buffer;
+    }
+
+    if (!cached || (*cached != buffer))
+    {
+        GL_COUNT_CALL(BindBuffer);
+        glBindBuffer(target, buffer);
+        if (cached)
+        {
+            *cached = buffer;
+        }
+    }
+    else
+    {
+        GL_COUNT_FILTERED_CALL(BindBuffer);
+    }
+}
+
+internal void
+gl_cached_bind_framebuffer(GLenum target, GLuint framebuffer)
+{
+    if ((target != GL_FRAMEBUFFER) || (gl_state_cache.framebuffer != framebuffer))
+    {
+        GL_COUNT_CALL(BindFramebuffer);
+        glBindFramebuffer(target, framebuffer);
+        gl_state_cache.framebuffer = (target == GL_FRAMEBUFFER) ? framebuffer : GL_STATE_UNKNOWN;
+    }
+    else
+    {
+        GL_COUNT_FILTERED_CALL(BindFramebuffer);
+    }
+}
+
+internal void
+gl_cached_active_texture(GLenum texture)
+{
+    u32 unit = texture - GL_TEXTURE0;
+    if ((unit >= GL_STATE_CACHE_TEXTURE_UNITS) || (gl_state_cache.active_texture_unit != unit))
+    {
+        GL_COUNT_CALL(ActiveTexture);
+        glActiveTexture(texture);
+        gl_state_cache.active_texture_unit = (unit < GL_STATE_CACHE_TEXTURE_UNITS) ? unit : GL_STATE_UNKNOWN;
+    }
+    else
+    {
+        GL_COUNT_FILTERED_CALL(ActiveTexture);
+    }
+}
+
+internal void
+gl_cached_bind_texture(GLenum target, GLuint texture)
+{
+    u32 unit = gl_state_cache.active_texture_unit;
+    if ((target != GL_TEXTURE_2D) || (unit == GL_STATE_UNKNOWN) || (gl_state_cache.texture_2d[unit] != texture))
+    {
+        GL_COUNT_CALL(BindTexture);
+        glBindTexture(target, texture);
+        if ((target == GL_TEXTURE_2D) && (unit != GL_STATE_UNKNOWN))
+        {
+            gl_state_cache.texture_2d[unit] = texture;
+        }
+    }
+    else
+    {
+        GL_COUNT_FILTERED_CALL(BindTexture);
+    }
+}
+
+// NOTE(Nader): GL puts a deleted name's binding back to 0 wherever it was bound, so the cache does too.
+internal void
+gl_cached_delete_buffers(GLsizei n, const GLuint *buffers)
+{
+    GL_COUNT_CALL(DeleteBuffers);
+    glDeleteBuffers(n, buffers);
+    for (GLsizei buffer_index = 0; buffer_index < n; ++buffer_index)
+    {
+        if (gl_state_cache.array_buffer == buffers[buffer_index])
+        {
+            gl_state_cache.array_buffer = 0;
+        }
+        if (gl_state_cache.element_array_buffer == buffers[buffer_index])
+        {
+            gl_state_cache.element_array_buffer = 0;
+        }
+    }
+}
+
+internal void
+gl_cached_delete_vertex_arrays(GLsizei n, const GLuint *arrays)
+{
+    GL_COUNT_CALL(DeleteVertexArrays);
+    glDeleteVertexArrays(n, arrays);
+    for (GLsizei array_index = 0; array_index < n; ++array_index)
+    {
+        if (gl_state_cache.vertex_array == arrays[array_index])
+        {
+            gl_state_cache.vertex_array = 0;
+            gl_state_cache.element_array_buffer = GL_STATE_UNKNOWN;
+        }
+    }
+}
+
+internal void
+gl_cached_delete_framebuffers(GLsizei n, const GLuint *framebuffers)
+{
+    GL_COUNT_CALL(DeleteFramebuffers);
+    glDeleteFramebuffers(n, framebuffers);
+    for (GLsizei framebuffer_index = 0; framebuffer_index < n; ++framebuffer_index)
+    {
+        if (gl_state_cache.framebuffer == framebuffers[framebuffer_index])
+        {
+            gl_state_cache.framebuffer = 0;
+        }
+    }
+}
+
+internal void
+gl_cached_delete_textures(GLsizei n, const GLuint *textures)
+{
+    GL_COUNT_CALL(DeleteTextures);
+    glDeleteTextures(n, textures);
+    for (GLsizei texture_index = 0; texture_index < n; ++texture_index)
+    {
+        for (u32 unit_index = 0; unit_index < GL_STATE_CACHE_TEXTURE_UNITS; ++unit_index)
+        {
+            if (gl_state_cache.texture_2d[unit_index] == textures[texture_index])
+            {
+                gl_state_cache.texture_2d[unit_index] = 0;
+            }
+        }
+    }
+}
+
+// NOTE(Nader): Only GL_BLEND is tracked, every other cap goes straight through.
+internal void
+gl_cached_set_capability(GLenum cap, b32 enable)
+{
+    if ((cap != GL_BLEND) || (gl_state_cache.blend != (u32)enable))
+    {
+        if (enable)
+        {
+            GL_COUNT_CALL(Enable);
+            glEnable(cap);
+        }
+        else
+        {
+            GL_COUNT_CALL(Disable);
+            glDisable(cap);
+        }
+        if (cap == GL_BLEND)
+        {
+            gl_state_cache.blend = (u32)enable;
+        }
+    }
+    else if (enable)
+    {
+        GL_COUNT_FILTERED_CALL(Enable);
+    }
+    else
+    {
+        GL_COUNT_FILTERED_CALL(Disable);
+    }
+}
+
+internal void
+gl_cached_blend_func(GLenum source, GLenum dest)
+{
+    if ((gl_state_cache.blend_source != source) || (gl_state_cache.blend_dest != dest))
+    {
+        GL_COUNT_CALL(BlendFunc);
+        glBlendFunc(source, dest);
+        gl_state_cache.blend_source = source;
+        gl_state_cache.blend_dest = dest;
+    }
+    else
+    {
+        GL_COUNT_FILTERED_CALL(BlendFunc);
+    }
+}
+
+internal void
+gl_cached_viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    i32 *viewport = gl_state_cache.viewport;
+    if (!gl_state_cache.viewport_is_known ||
+        (viewport[0] != x) || (viewport[1] != y) || (viewport[2] != width) || (viewport[3] != height))
+    {
+        GL_COUNT_CALL(Viewport);
+        glViewport(x, y, width, height);
+        viewport[0] = x;
+        viewport[1] = y;
+        viewport[2] = width;
+        viewport[3] = height;
+        gl_state_cache.viewport_is_known = true;
+    }
+    else
+    {
+        GL_COUNT_FILTERED_CALL(Viewport);
+    }
+}
+
+internal void
+gl_cached_clear_color(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha)
+{
+    f32 *color = gl_state_cache.clear_color;
+    if (!gl_state_cache.clear_color_is_known ||
+        (color[0] != red) || (color[1] != green) || (color[2] != blue) || (color[3] != alpha))
+    {
+        GL_COUNT_CALL(ClearColor);
+        glClearColor(red, green, blue, alpha);
+        color[0] = red;
+        color[1] = green;
+        color[2] = blue;
+        color[3] = alpha;
+        gl_state_cache.clear_color_is_known = true;
+    }
+    else
+    {
+        GL_COUNT_FILTERED_CALL(ClearColor);
+    }
+}
+
+// NOTE(Nader): A function-like macro isn't expanded again inside its own expansion, so the gl* in these is the real one.
+#define glUseProgram(program) gl_cached_use_program(program)
+#define glBindVertexArray(array) gl_cached_bind_vertex_array(array)
+#define glBindBuffer(target, buffer) gl_cached_bind_buffer(target, buffer)
+#define glBindFramebuffer(target, framebuffer) gl_cached_bind_framebuffer(target, framebuffer)
+#define glActiveTexture(texture) gl_cached_active_texture(texture)
+#define glBindTexture(target, texture) gl_cached_bind_texture(target, texture)
+#define glDeleteBuffers(n, buffers) gl_cached_delete_buffers(n, buffers)
+#define glDeleteVertexArrays(n, arrays) gl_cached_delete_vertex_arrays(n, arrays)
+#define glDeleteFramebuffers(n, framebuffers) gl_cached_delete_framebuffers(n, framebuffers)
+#define glDeleteTextures(n, textures) gl_cached_delete_textures(n, textures)
+#define glEnable(cap) gl_cached_set_capability(cap, true)
+#define glDisable(cap) gl_cached_set_capability(cap, false)
+#define glBlendFunc(source, dest) gl_cached_blend_func(source, dest)
+#define glViewport(x, y, width, height) gl_cached_viewport(x, y, width, height)
+#define glClearColor(red, green, blue, alpha) gl_cached_clear_color(red, green, blue, alpha)
+
+#define glAttachShader(...) (GL_COUNT_CALL(AttachShader), glAttachShader(__VA_ARGS__))
+#define glBufferData(...) (GL_COUNT_CALL(BufferData), glBufferData(__VA_ARGS__))
+#define glBufferSubData(...) (GL_COUNT_CALL(BufferSubData), glBufferSubData(__VA_ARGS__))
+#define glCheckFramebufferStatus(...) (GL_COUNT_CALL(CheckFramebufferStatus), glCheckFramebufferStatus(__VA_ARGS__))
+#define glClearBufferfv(...) (GL_COUNT_CALL(ClearBufferfv), glClearBufferfv(__VA_ARGS__))
+#define glCompileShader(...) (GL_COUNT_CALL(CompileShader), glCompileShader(__VA_ARGS__))
+#define glCreateProgram() (GL_COUNT_CALL(CreateProgram), glCreateProgram())
+#define glCreateShader(...) (GL_COUNT_CALL(CreateShader), glCreateShader(__VA_ARGS__))
+#define glEnableVertexAttribArray(...) (GL_COUNT_CALL(EnableVertexAttribArray), glEnableVertexAttribArray(__VA_ARGS__))
+#define glDrawBuffers(...) (GL_COUNT_CALL(DrawBuffers), glDrawBuffers(__VA_ARGS__))
+#define glFramebufferTexture2D(...) (GL_COUNT_CALL(FramebufferTexture2D), glFramebufferTexture2D(__VA_ARGS__))
+#define glGenBuffers(...) (GL_COUNT_CALL(GenBuffers), glGenBuffers(__VA_ARGS__))
+#define glGenFramebuffers(...) (GL_COUNT_CALL(GenFramebuffers), glGenFramebuffers(__VA_ARGS__))
+#define glGetAttribLocation(...) (GL_COUNT_CALL(GetAttribLocation), glGetAttribLocation(__VA_ARGS__))
+#define glGetShaderInfoLog(...) (GL_COUNT_CALL(GetShaderInfoLog), glGetShaderInfoLog(__VA_ARGS__))
+#define glGetShaderiv(...) (GL_COUNT_CALL(GetShaderiv), glGetShaderiv(__VA_ARGS__))
+#define glGetUniformLocation(...) (GL_COUNT_CALL(GetUniformLocation), glGetUniformLocation(__VA_ARGS__))
+#define glLinkProgram(...) (GL_COUNT_CALL(LinkProgram), glLinkProgram(__VA_ARGS__))
+#define glShaderSource(...) (GL_COUNT_CALL(ShaderSource), glShaderSource(__VA_ARGS__))
+#define glUniform1i(...) (GL_COUNT_CALL(Uniform1i), glUniform1i(__VA_ARGS__))
+#define glUniform1f(...) (GL_COUNT_CALL(Uniform1f), glUniform1f(__VA_ARGS__))
+#define glUniform2f(...) (GL_COUNT_CALL(Uniform2f), glUniform2f(__VA_ARGS__))
+#define glUniform4f(...) (GL_COUNT_CALL(Uniform4f), glUniform4f(__VA_ARGS__))
+#define glUniformMatrix4fv(...) (GL_COUNT_CALL(UniformMatrix4fv), glUniformMatrix4fv(__VA_ARGS__))
+#define glVertexAttribPointer(...) (GL_COUNT_CALL(VertexAttribPointer), glVertexAttribPointer(__VA_ARGS__))
+#define glGetProgramiv(...) (GL_COUNT_CALL(GetProgramiv), glGetProgramiv(__VA_ARGS__))
+#define glDeleteShader(...) (GL_COUNT_CALL(DeleteShader), glDeleteShader(__VA_ARGS__))
+#define glGenVertexArrays(...) (GL_COUNT_CALL(GenVertexArrays), glGenVertexArrays(__VA_ARGS__))
+#define glGenerateMipmap(...) (GL_COUNT_CALL(GenerateMipmap), glGenerateMipmap(__VA_ARGS__))
+#define glVertexAttribDivisor(...) (GL_COUNT_CALL(VertexAttribDivisor), glVertexAttribDivisor(__VA_ARGS__))
+#define glDrawElementsInstanced(...) (GL_COUNT_CALL(DrawElementsInstanced), glDrawElementsInstanced(__VA_ARGS__))
+#define glBlendEquation(...) (GL_COUNT_CALL(BlendEquation), glBlendEquation(__VA_ARGS__))
+#define glClear(...) (GL_COUNT_CALL(Clear), glClear(__VA_ARGS__))
+#define glGenTextures(...) (GL_COUNT_CALL(GenTextures), glGenTextures(__VA_ARGS__))
+#define glTexImage2D(...) (GL_COUNT_CALL(TexImage2D), glTexImage2D(__VA_ARGS__))
+#define glTexParameteri(...) (GL_COUNT_CALL(TexParameteri), glTexParameteri(__VA_ARGS__))
+#define glTexSubImage2D(...) (GL_COUNT_CALL(TexSubImage2D), glTexSubImage2D(__VA_ARGS__))
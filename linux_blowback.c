@@ -0,0 +1,1832 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "platform.h"
+#include "frame_pacer.h"
+#include "profiler.h"
+#include "memory_arena.h"
+#include "transform2d.h"
+#include "renderer.h"
+#include "simd.h"
+#include "entity.h"
+#include "tilemap.h"
+#include "spatial_hash.h"
+#include "asset_pack.h"
+#include "asset.h"
+#include "camera.h"
+#include "blowback.h"
+#include "work_queue.h"
+#include "linux_blowback.h"
+
+#include "renderer_software.c"
+#include "replay.c"
+#include "entity_integrate.c"
+#include "simd_math.c"
+#include "entity.c"
+#include "spatial_hash.c"
+
+/*
+
+NOTE(Nader): Headless Linux host. There is no window, no GL context and no real input.
+It allocates GameMemory, fills GameInput from a script and runs the game as fast as it
+can for a fixed number of frames, then reports how long the frames took.
+Frames are drawn with the software renderer unless -norender is passed, and -dump
+writes the last frame out as a binary PPM for golden image comparisons.
+
+Usage:
+	blowback_linux [-frames N] [-hz N] [-render_hz N] [-script path] [-norender] [-dump path.ppm]
+				   [-hugepages] [-record path] [-playback path] [-pace] [-trace path.json] [-threads N]
+	blowback_linux -integrate_benchmark entity_count
+	blowback_linux -broadphase_benchmark entity_count
+	blowback_linux -math_benchmark point_count
+
+-hz is the fixed simulation rate (game_update_hz) and -render_hz the rate frames are
+drawn at, the same as -hz unless given. Time only advances by 1 / render_hz per frame
+whatever the wall clock says, so every run simulates the same steps, and a frame
+simulates as many of them as fit before drawing (see game_simulate in blowback.h).
+-frames counts drawn frames.
+
+-pace runs the frames in real time at -render_hz through the frame pacer (see
+frame_pacer.h) instead of back to back, and the frame times in the report are then start
+to start.
+
+Frames are instrumented with TIMED_BLOCK (see profiler.h) and the report ends with the
+average cost of every block per frame. -trace writes the last frames' blocks out as a
+Chrome trace.
+
+The game code is loaded from blowback_game.so next to the executable and reloaded when
+it is rebuilt (./build.sh game) while we run, game memory carries over.
+
+-integrate_benchmark doesn't run the game. It times every integration kernel this
+machine supports (see entity_integrate.c) over entity_count entities, then the best one
+split across the work queue, and checks that they all give the same bits as the scalar
+loop.
+
+-broadphase_benchmark doesn't run the game either. It moves entity_count boxes around for a
+few seconds of frames, times the spatial hash update and pair search (see spatial_hash.h)
+and checks its pairs, box queries and raycasts against testing every box.
+
+-math_benchmark times the batched math kernels in simd_math.c at every level this machine
+supports and checks them against the scalar ones.
+
+-hugepages backs game memory with 2 MB pages to cut TLB misses, see linux_allocate_game_memory.
+
+-threads is how many threads run the game's work queue, counting the main thread. The
+default is one per online CPU.
+
+Script format, one step per line, '#' starts a comment:
+	<frame_count> [up] [down] [left] [right] [action_up] ... [start]
+frame_count is in simulate steps, not drawn frames.
+
+The script loops when it runs out of steps. With no script we walk the player in a square.
+
+-record writes the run out as a replay (see replay.c). -playback replaces the script with
+a replay, looping it from its starting snapshot until -frames frames have run. At the end
+of every loop the state is hashed, and the report says whether every loop ended in the
+same state. The final state hash is always printed so two runs can be diffed.
+
+*/
+
+const u32 WINDOW_WIDTH = 1280;
+const u32 WINDOW_HEIGHT = 720;
+
+global char *button_names[] =
+{
+	"up", "down", "left", "right",
+	"action_up", "action_down", "action_left", "action_right",
+	"left_shoulder", "right_shoulder",
+	"select", "start",
+};
+
+internal f64
+linux_get_seconds_elapsed(struct timespec start, struct timespec end)
+{
+	f64 result = (f64)(end.tv_sec - start.tv_sec) +
+				 (f64)(end.tv_nsec - start.tv_nsec) / 1000000000.0;
+	return(result);
+}
+
+internal struct timespec
+linux_get_wall_clock(void)
+{
+	struct timespec wall_clock;
+	clock_gettime(CLOCK_MONOTONIC, &wall_clock);
+	return(wall_clock);
+}
+
+internal struct timespec
+linux_add_seconds(struct timespec time, f64 seconds)
+{
+	i64 nanoseconds = (i64)time.tv_nsec + (i64)(seconds*1000000000.0);
+	time.tv_sec += nanoseconds / 1000000000;
+	time.tv_nsec = nanoseconds % 1000000000;
+	return(time);
+}
+
+internal f64
+linux_get_process_cpu_seconds(void)
+{
+	struct timespec cpu_time;
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu_time);
+	f64 result = (f64)cpu_time.tv_sec + (f64)cpu_time.tv_nsec / 1000000000.0;
+	return(result);
+}
+
+// NOTE(Nader): The game library and friends live next to the executable, not in the working directory.
+internal void
+linux_get_exe_filepath(LinuxState *state)
+{
+	ssize_t length = readlink("/proc/self/exe", state->exe_filepath, sizeof(state->exe_filepath) - 1);
+	if (length < 0)
+	{
+		length = 0;
+	}
+	state->exe_filepath[length] = 0;
+
+	state->one_past_last_exe_filepath_slash = state->exe_filepath;
+	for (char *at = state->exe_filepath; *at; ++at)
+	{
+		if (*at == '/')
+		{
+			state->one_past_last_exe_filepath_slash = at + 1;
+		}
+	}
+}
+
+internal void
+linux_build_exe_path_filepath(LinuxState *state, char *filename, char *dest, u32 dest_size)
+{
+	snprintf(dest, dest_size, "%.*s%s", (int)(state->one_past_last_exe_filepath_slash - state->exe_filepath),
+			 state->exe_filepath, filename);
+}
+
+internal struct timespec
+linux_get_last_write_time(char *filepath)
+{
+	struct timespec result = {0};
+	struct stat file_stat;
+	if (stat(filepath, &file_stat) == 0)
+	{
+		result = file_stat.st_mtim;
+	}
+	return(result);
+}
+
+internal b32
+linux_copy_file(char *source_filepath, char *dest_filepath)
+{
+	b32 result = false;
+	int source_file = open(source_filepath, O_RDONLY);
+	if (source_file >= 0)
+	{
+		int dest_file = open(dest_filepath, O_WRONLY | O_CREAT | O_TRUNC, 0700);
+		if (dest_file >= 0)
+		{
+			result = true;
+			char buffer[65536];
+			ssize_t bytes_read;
+			while ((bytes_read = read(source_file, buffer, sizeof(buffer))) > 0)
+			{
+				if (write(dest_file, buffer, bytes_read) != bytes_read)
+				{
+					result = false;
+					break;
+				}
+			}
+			if (bytes_read < 0)
+			{
+				result = false;
+			}
+			close(dest_file);
+		}
+		close(source_file);
+	}
+	return(result);
+}
+
+GAME_SIMULATE(game_simulate_stub)
+{
+}
+
+GAME_RENDER(game_render_stub)
+{
+}
+
+/*
+
+NOTE(Nader): dlopen hands back the library it already has for a path it has seen, and the
+compiler rewrites the .so in place, so we load a private copy under a new name each time
+and unlink it as soon as it is mapped.
+
+*/
+internal void
+linux_load_game_code(LinuxGameCode *game_code, char *source_library_filepath, char *temp_library_filepath_prefix)
+{
+	game_code->library_last_write_time = linux_get_last_write_time(source_library_filepath);
+
+	char temp_library_filepath[4096];
+	snprintf(temp_library_filepath, sizeof(temp_library_filepath), "%s_%d_%u.so",
+			 temp_library_filepath_prefix, (int)getpid(), game_code->load_count);
+	if (linux_copy_file(source_library_filepath, temp_library_filepath))
+	{
+		game_code->library = dlopen(temp_library_filepath, RTLD_NOW | RTLD_LOCAL);
+		unlink(temp_library_filepath);
+		if (game_code->library)
+		{
+			game_code->simulate = (game_simulate_function *)dlsym(game_code->library, "game_simulate");
+			game_code->render = (game_render_function *)dlsym(game_code->library, "game_render");
+			game_code->is_valid = (game_code->simulate && game_code->render);
+		}
+	}
+
+	if (game_code->is_valid)
+	{
+		++game_code->load_count;
+	}
+	else
+	{
+		if (game_code->library)
+		{
+			dlclose(game_code->library);
+			game_code->library = 0;
+		}
+		game_code->simulate = game_simulate_stub;
+		game_code->render = game_render_stub;
+	}
+}
+
+internal void
+linux_unload_game_code(LinuxGameCode *game_code)
+{
+	if (game_code->library)
+	{
+		dlclose(game_code->library);
+		game_code->library = 0;
+	}
+	game_code->is_valid = false;
+	game_code->simulate = game_simulate_stub;
+	game_code->render = game_render_stub;
+}
+
+internal PLATFORM_ADD_ENTRY(linux_add_entry)
+{
+	if (work_queue_add_entry(queue, callback, data))
+	{
+		sem_post((sem_t *)queue->semaphore);
+	}
+}
+
+internal PLATFORM_COMPLETE_ALL_WORK(linux_complete_all_work)
+{
+	work_queue_complete_all_work(queue);
+}
+
+// NOTE(Nader): Workers live as long as the process and sleep on the semaphore whenever they run out of work.
+internal void *
+linux_work_queue_thread_proc(void *parameter)
+{
+	LinuxThreadStartup *startup = (LinuxThreadStartup *)parameter;
+	PlatformWorkQueue *queue = startup->queue;
+	work_queue_thread_index = startup->thread_index;
+	for (;;)
+	{
+		if (!work_queue_do_next_entry(queue))
+		{
+			sem_wait((sem_t *)queue->semaphore);
+		}
+	}
+	return(0);
+}
+
+// NOTE(Nader): thread_count counts the calling thread, which is thread 0 and starts no thread.
+internal b32
+linux_make_work_queue(PlatformWorkQueue *queue, u32 thread_count, sem_t *semaphore, LinuxThreadStartup *startups)
+{
+	b32 result = (sem_init(semaphore, 0, 0) == 0);
+	if (result)
+	{
+		work_queue_init(queue, thread_count, semaphore);
+		for (u32 thread_index = 1; result && (thread_index < thread_count); ++thread_index)
+		{
+			LinuxThreadStartup *startup = &startups[thread_index];
+			startup->queue = queue;
+			startup->thread_index = thread_index;
+
+			pthread_t thread;
+			result = (pthread_create(&thread, 0, linux_work_queue_thread_proc, startup) == 0);
+			if (result)
+			{
+				pthread_detach(thread);
+			}
+		}
+	}
+	return(result);
+}
+
+// NOTE(Nader): The build holds the lock file while it writes the library, don't load a half written one.
+internal b32
+linux_game_code_changed(LinuxGameCode *game_code, char *source_library_filepath, char *lock_filepath)
+{
+	struct timespec last_write_time = linux_get_last_write_time(source_library_filepath);
+	b32 result = (((last_write_time.tv_sec != game_code->library_last_write_time.tv_sec) ||
+				   (last_write_time.tv_nsec != game_code->library_last_write_time.tv_nsec)) &&
+				  (access(lock_filepath, F_OK) != 0));
+	return(result);
+}
+
+/*
+
+NOTE(Nader): Sleeps until just before deadline on an absolute CLOCK_MONOTONIC timer, so
+being preempted between reading the clock and going to sleep doesn't make us wake up
+later, then spins the rest of the way. Returns false if the deadline had already passed.
+
+*/
+internal b32
+linux_wait_for_frame_deadline(FramePacer *pacer, struct timespec deadline)
+{
+	struct timespec now = linux_get_wall_clock();
+	f64 seconds_remaining = linux_get_seconds_elapsed(now, deadline);
+	if (seconds_remaining <= 0.0)
+	{
+		return(false);
+	}
+
+	f64 sleep_seconds = frame_pacer_sleep_seconds(pacer, seconds_remaining);
+	if (sleep_seconds > 0.0)
+	{
+		struct timespec wake_time = linux_add_seconds(now, sleep_seconds);
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake_time, 0) == EINTR)
+		{
+		}
+		struct timespec woke_counter = linux_get_wall_clock();
+		frame_pacer_record_sleep(pacer, sleep_seconds, linux_get_seconds_elapsed(now, woke_counter));
+		now = woke_counter;
+	}
+
+	struct timespec spin_start_counter = now;
+	while (linux_get_seconds_elapsed(now, deadline) > 0.0)
+	{
+		_mm_pause();
+		now = linux_get_wall_clock();
+	}
+	frame_pacer_record_spin(pacer, linux_get_seconds_elapsed(spin_start_counter, now));
+	return(true);
+}
+
+typedef struct FileReadResults
+{
+	u32 contents_size;
+	void *contents;
+} FileReadResults;
+
+internal void
+free_file_memory(FileReadResults *file)
+{
+	if (file->contents)
+	{
+		munmap(file->contents, file->contents_size + 1);
+		file->contents = 0;
+		file->contents_size = 0;
+	}
+}
+
+// NOTE(Nader): Contents are null terminated so text files can be parsed in place.
+internal FileReadResults
+read_file_to_memory(char *filepath)
+{
+	FileReadResults result = { 0 };
+	int file_handle = open(filepath, O_RDONLY);
+	if (file_handle != -1)
+	{
+		struct stat file_status;
+		if (fstat(file_handle, &file_status) == 0)
+		{
+			u32 file_size_32 = (u32)file_status.st_size;
+			result.contents = mmap(0, file_size_32 + 1, PROT_READ | PROT_WRITE,
+								   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (result.contents != MAP_FAILED)
+			{
+				ssize_t bytes_read = read(file_handle, result.contents, file_size_32);
+				if (bytes_read == (ssize_t)file_size_32)
+				{
+					result.contents_size = file_size_32;
+				}
+				else
+				{
+					munmap(result.contents, file_size_32 + 1);
+					result.contents = 0;
+				}
+			}
+			else
+			{
+				result.contents = 0;
+			}
+		}
+		close(file_handle);
+	}
+	return(result);
+}
+
+// NOTE(Nader): Maps the whole pack read only. Leaves pack->base 0 if there is no pack or it isn't one we understand.
+internal void
+linux_map_asset_pack(char *filepath, AssetPack *pack)
+{
+	pack->base = 0;
+	pack->size = 0;
+	int file_handle = open(filepath, O_RDONLY);
+	if (file_handle != -1)
+	{
+		struct stat file_status;
+		if ((fstat(file_handle, &file_status) == 0) && (file_status.st_size > 0))
+		{
+			void *base = mmap(0, (size_t)file_status.st_size, PROT_READ, MAP_PRIVATE, file_handle, 0);
+			if (base != MAP_FAILED)
+			{
+				pack->base = (u8 *)base;
+				pack->size = (u64)file_status.st_size;
+				if (!open_asset_pack(pack))
+				{
+					munmap(base, (size_t)file_status.st_size);
+					pack->base = 0;
+					pack->size = 0;
+				}
+			}
+		}
+		// NOTE(Nader): The mapping keeps the file open.
+		close(file_handle);
+	}
+}
+
+internal PLATFORM_READ_ENTIRE_FILE(linux_read_entire_file)
+{
+	PlatformFileContents result = { 0 };
+	int file_handle = open(filepath, O_RDONLY);
+	if (file_handle != -1)
+	{
+		struct stat file_status;
+		if ((fstat(file_handle, &file_status) == 0) &&
+			((u64)file_status.st_size <= get_arena_size_remaining(arena, DEFAULT_ARENA_ALIGNMENT)) &&
+			(file_status.st_size <= 0xFFFFFFFF))
+		{
+			u32 file_size_32 = (u32)file_status.st_size;
+			void *contents = push_size(arena, file_size_32);
+			u32 bytes_read = 0;
+			while (bytes_read < file_size_32)
+			{
+				ssize_t read_result = read(file_handle, (u8 *)contents + bytes_read, file_size_32 - bytes_read);
+				if (read_result <= 0)
+				{
+					break;
+				}
+				bytes_read += (u32)read_result;
+			}
+			if (bytes_read == file_size_32)
+			{
+				result.size = file_size_32;
+				result.contents = contents;
+			}
+		}
+		close(file_handle);
+	}
+	return(result);
+}
+
+/*
+
+NOTE(Nader): Allocates permanent + transient storage as one block.
+
+In debug builds the block goes at a fixed address, so pointers into game memory are the
+same every run and a saved snapshot of the block can be replayed as is.
+
+With use_huge_pages we first ask for explicit 2 MB pages (MAP_HUGETLB, needs pages
+reserved in /proc/sys/vm/nr_hugepages). If there aren't enough we fall back to normal
+pages and madvise the block for transparent huge pages, which needs it 2 MB aligned.
+
+*/
+#define LINUX_HUGE_PAGE_SIZE megabytes(2)
+
+internal void *
+linux_map_game_memory(void *base_address, u64 size, int extra_flags)
+{
+	// NOTE(Nader): MAP_NORESERVE so the 1 GB transient block only costs the pages we touch. Not for
+	// hugetlb though, there it would let the map succeed without reserved pages and fault later.
+	int flags = MAP_PRIVATE | MAP_ANONYMOUS | extra_flags;
+	if (!(extra_flags & MAP_HUGETLB))
+	{
+		flags |= MAP_NORESERVE;
+	}
+	if (base_address)
+	{
+		flags |= MAP_FIXED_NOREPLACE;
+	}
+	void *result = mmap(base_address, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+	if (result == MAP_FAILED)
+	{
+		result = 0;
+	}
+	else if (base_address && (result != base_address))
+	{
+		// NOTE(Nader): Kernels older than 4.17 treat MAP_FIXED_NOREPLACE as a hint.
+		munmap(result, size);
+		result = 0;
+	}
+	return(result);
+}
+
+internal b32
+linux_allocate_game_memory(LinuxState *linux_state, u64 size, b32 use_huge_pages)
+{
+#if BLOWBACK_INTERNAL
+	void *base_address = (void *)terabytes(2);
+#else
+	void *base_address = 0;
+#endif
+	linux_state->total_size = align_pow2(size, LINUX_HUGE_PAGE_SIZE);
+	linux_state->game_memory_block = 0;
+	linux_state->page_backing = "4 KB pages";
+
+	if (use_huge_pages)
+	{
+		linux_state->game_memory_block = linux_map_game_memory(base_address, linux_state->total_size,
+															   MAP_HUGETLB);
+		if (linux_state->game_memory_block)
+		{
+			linux_state->page_backing = "2 MB hugetlb pages";
+		}
+	}
+
+	if (!linux_state->game_memory_block)
+	{
+		if (base_address)
+		{
+			linux_state->game_memory_block = linux_map_game_memory(base_address, linux_state->total_size, 0);
+		}
+		else
+		{
+			// NOTE(Nader): Over allocate so we can trim the block down to a 2 MB boundary.
+			u8 *block = (u8 *)linux_map_game_memory(0, linux_state->total_size + LINUX_HUGE_PAGE_SIZE, 0);
+			if (block)
+			{
+				u8 *aligned = (u8 *)align_pow2((u64)block, LINUX_HUGE_PAGE_SIZE);
+				u64 head = (u64)(aligned - block);
+				if (head)
+				{
+					munmap(block, head);
+				}
+				munmap(aligned + linux_state->total_size, LINUX_HUGE_PAGE_SIZE - head);
+				linux_state->game_memory_block = aligned;
+			}
+		}
+
+		if (linux_state->game_memory_block && use_huge_pages)
+		{
+			if (madvise(linux_state->game_memory_block, linux_state->total_size, MADV_HUGEPAGE) == 0)
+			{
+				linux_state->page_backing = "transparent huge pages";
+			}
+		}
+	}
+
+	return(linux_state->game_memory_block != 0);
+}
+
+internal b32
+linux_parse_input_script(LinuxInputScript *script, char *text)
+{
+	script->step_count = 0;
+	char *line = text;
+	while (line && *line)
+	{
+		char *next_line = strchr(line, '\n');
+		if (next_line)
+		{
+			*next_line++ = 0;
+		}
+
+		char *comment = strchr(line, '#');
+		if (comment)
+		{
+			*comment = 0;
+		}
+
+		char *token = strtok(line, " \t\r");
+		if (token)
+		{
+			if (script->step_count >= array_count(script->steps))
+			{
+				fprintf(stderr, "Input script has more than %d steps \n", (int)array_count(script->steps));
+				return(false);
+			}
+
+			LinuxScriptStep *step = &script->steps[script->step_count++];
+			step->frame_count = (u32)strtoul(token, 0, 10);
+			step->button_mask = 0;
+			while ((token = strtok(0, " \t\r")))
+			{
+				b32 found = false;
+				for (u32 button_index = 0; button_index < array_count(button_names); ++button_index)
+				{
+					if (strcmp(token, button_names[button_index]) == 0)
+					{
+						step->button_mask |= (1 << button_index);
+						found = true;
+					}
+				}
+				if (!found)
+				{
+					fprintf(stderr, "Unknown button '%s' in input script \n", token);
+					return(false);
+				}
+			}
+		}
+		line = next_line;
+	}
+	return(script->step_count > 0);
+}
+
+internal void
+linux_default_input_script(LinuxInputScript *script)
+{
+	script->step_count = 4;
+	script->steps[0] = (LinuxScriptStep){ 60, 1 << 3 };
+	script->steps[1] = (LinuxScriptStep){ 60, 1 << 0 };
+	script->steps[2] = (LinuxScriptStep){ 60, 1 << 2 };
+	script->steps[3] = (LinuxScriptStep){ 60, 1 << 1 };
+}
+
+internal void
+linux_process_script_button(b32 is_down, GameButtonState *old_state, GameButtonState *new_state)
+{
+	new_state->ended_down = is_down;
+	new_state->half_transition_count = (old_state->ended_down != new_state->ended_down) ? 1 : 0;
+}
+
+internal void
+linux_process_input_script(LinuxInputScript *script, GameControllerInput *old_controller,
+						   GameControllerInput *new_controller)
+{
+	LinuxScriptStep *step = &script->steps[script->step_index];
+	new_controller->is_connected = true;
+	new_controller->is_analog = false;
+	for (u32 button_index = 0; button_index < array_count(button_names); ++button_index)
+	{
+		b32 is_down = (step->button_mask & (1 << button_index)) != 0;
+		linux_process_script_button(is_down, &old_controller->buttons[button_index],
+									&new_controller->buttons[button_index]);
+	}
+
+	if (++script->frames_into_step >= step->frame_count)
+	{
+		script->frames_into_step = 0;
+		script->step_index = (script->step_index + 1) % script->step_count;
+	}
+}
+
+// NOTE(Nader): Writes the framebuffer top row first, PPM is top-down and we are bottom-up.
+internal b32
+linux_write_framebuffer_ppm(SoftwareFramebuffer *framebuffer, char *filepath)
+{
+	b32 result = false;
+	FILE *file = fopen(filepath, "wb");
+	if (file)
+	{
+		fprintf(file, "P6\n%u %u\n255\n", framebuffer->width, framebuffer->height);
+		u8 row_bytes[3*4096];
+		asserts(framebuffer->width <= 4096);
+		for (i32 y = (i32)framebuffer->height - 1; y >= 0; --y)
+		{
+			u32 *row = framebuffer->pixels + y*framebuffer->pitch;
+			for (u32 x = 0; x < framebuffer->width; ++x)
+			{
+				row_bytes[3*x + 0] = (u8)(row[x] >> 16);
+				row_bytes[3*x + 1] = (u8)(row[x] >> 8);
+				row_bytes[3*x + 2] = (u8)(row[x] >> 0);
+			}
+			fwrite(row_bytes, 3, framebuffer->width, file);
+		}
+		result = (ferror(file) == 0);
+		fclose(file);
+	}
+	return(result);
+}
+
+internal void
+linux_write_to_file(void *context, char *text, u32 length)
+{
+	fwrite(text, 1, length, (FILE *)context);
+}
+
+internal int
+compare_f64(const void *a, const void *b)
+{
+	f64 left = *(f64 *)a;
+	f64 right = *(f64 *)b;
+	return((left > right) - (left < right));
+}
+
+internal f64
+linux_percentile(f64 *sorted, u32 count, f64 percentile)
+{
+	u32 index = (u32)(percentile * (f64)(count - 1) + 0.5);
+	return(sorted[index]);
+}
+
+internal u32
+linux_xorshift(u32 *state)
+{
+	u32 x = *state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return(x);
+}
+
+internal int
+linux_run_integrate_benchmark(PlatformWorkQueue *work_queue, u32 thread_count, u32 entity_count)
+{
+	u32 array_size = (u32)align_pow2((u64)entity_count*sizeof(f32), ENTITY_ARRAY_ALIGNMENT);
+	// NOTE(Nader): 4 arrays of starting state, 4 to run on and 4 holding the scalar result.
+	u8 *memory = (u8 *)mmap(0, 12*(u64)array_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED)
+	{
+		fprintf(stderr, "Could not allocate %u entities \n", entity_count);
+		return(1);
+	}
+	f32 *initial[4];
+	f32 *work[4];
+	f32 *reference[4];
+	for (u32 array_index = 0; array_index < 4; ++array_index)
+	{
+		initial[array_index] = (f32 *)(memory + (0 + array_index)*(u64)array_size);
+		work[array_index] = (f32 *)(memory + (4 + array_index)*(u64)array_size);
+		reference[array_index] = (f32 *)(memory + (8 + array_index)*(u64)array_size);
+	}
+
+	u32 random_state = 0x12345678;
+	for (u32 entity_index = 0; entity_index < entity_count; ++entity_index)
+	{
+		for (u32 array_index = 0; array_index < 4; ++array_index)
+		{
+			initial[array_index][entity_index] = (f32)(linux_xorshift(&random_state) % 20001) - 10000.0f;
+		}
+	}
+
+	f32 dt = 1.0f / 60.0f;
+	f32 velocity_scale = 1.0f / (1.0f + ENTITY_DRAG*dt);
+	u32 check_pass_count = 60;
+	u32 timed_pass_count = (u32)(200000000ull / ((u64)entity_count + 1)) + 10;
+
+	SimdLevel best_level = simd_get_level();
+	SimdLevel levels[SimdLevel_Count];
+	u32 level_count = 0;
+	levels[level_count++] = SimdLevel_Scalar;
+#if SIMD_X86
+	levels[level_count++] = SimdLevel_SSE2;
+	if (best_level == SimdLevel_AVX2)
+	{
+		levels[level_count++] = SimdLevel_AVX2;
+	}
+#elif SIMD_NEON
+	levels[level_count++] = SimdLevel_NEON;
+#endif
+
+	printf("integrate benchmark: %u entities, %.01f MB of components, best kernel here: %s \n", entity_count,
+		   (f64)(4*(u64)array_size) / (f64)megabytes(1), simd_level_names[best_level]);
+	f64 scalar_seconds = 0.0;
+	for (u32 level_index = 0; level_index < level_count; ++level_index)
+	{
+		SimdLevel level = levels[level_index];
+
+		for (u32 array_index = 0; array_index < 4; ++array_index)
+		{
+			memcpy(work[array_index], initial[array_index], array_size);
+		}
+		for (u32 pass_index = 0; pass_index < check_pass_count; ++pass_index)
+		{
+			integrate_entity_arrays(level, work[0], work[1], work[2], work[3], entity_count, dt, velocity_scale);
+		}
+		b32 matches_scalar = true;
+		for (u32 array_index = 0; array_index < 4; ++array_index)
+		{
+			if (level == SimdLevel_Scalar)
+			{
+				memcpy(reference[array_index], work[array_index], array_size);
+			}
+			else if (memcmp(reference[array_index], work[array_index], (u64)entity_count*sizeof(f32)) != 0)
+			{
+				matches_scalar = false;
+			}
+		}
+
+		// NOTE(Nader): Best pass, the others only measure whatever else the machine was doing.
+		f64 best_seconds = 1e9;
+		for (u32 pass_index = 0; pass_index < timed_pass_count; ++pass_index)
+		{
+			struct timespec pass_start = linux_get_wall_clock();
+			integrate_entity_arrays(level, work[0], work[1], work[2], work[3], entity_count, dt, velocity_scale);
+			f64 seconds = linux_get_seconds_elapsed(pass_start, linux_get_wall_clock());
+			if (seconds < best_seconds)
+			{
+				best_seconds = seconds;
+			}
+		}
+		if (level == SimdLevel_Scalar)
+		{
+			scalar_seconds = best_seconds;
+		}
+
+		printf("%-6s  %9.03f us/pass | %8.01f Mentities/s | %5.02fx scalar | same bits as scalar: %s \n",
+			   simd_level_names[level], 1000000.0*best_seconds, (f64)entity_count / best_seconds / 1000000.0,
+			   scalar_seconds / best_seconds, matches_scalar ? "yes" : "NO");
+	}
+
+	// NOTE(Nader): The best kernel again, split across the work queue the way the game runs it.
+	GameMemory game_memory = {0};
+	game_memory.work_queue = work_queue;
+	game_memory.work_queue_thread_count = thread_count;
+	game_memory.platform_add_entry = linux_add_entry;
+	game_memory.platform_complete_all_work = linux_complete_all_work;
+
+	EntityStore store = {0};
+	store.count = entity_count;
+	store.position_x = work[0];
+	store.position_y = work[1];
+	store.velocity_x = work[2];
+	store.velocity_y = work[3];
+	f32 drag = ENTITY_DRAG;
+
+	for (u32 array_index = 0; array_index < 4; ++array_index)
+	{
+		memcpy(work[array_index], initial[array_index], array_size);
+	}
+	for (u32 pass_index = 0; pass_index < check_pass_count; ++pass_index)
+	{
+		integrate_entities_on_queue(&game_memory, best_level, &store, dt, drag);
+	}
+	b32 queue_matches_scalar = true;
+	for (u32 array_index = 0; array_index < 4; ++array_index)
+	{
+		if (memcmp(reference[array_index], work[array_index], (u64)entity_count*sizeof(f32)) != 0)
+		{
+			queue_matches_scalar = false;
+		}
+	}
+
+	f64 best_queue_seconds = 1e9;
+	for (u32 pass_index = 0; pass_index < timed_pass_count; ++pass_index)
+	{
+		struct timespec pass_start = linux_get_wall_clock();
+		integrate_entities_on_queue(&game_memory, best_level, &store, dt, drag);
+		f64 seconds = linux_get_seconds_elapsed(pass_start, linux_get_wall_clock());
+		if (seconds < best_queue_seconds)
+		{
+			best_queue_seconds = seconds;
+		}
+	}
+	printf("%-6s  %9.03f us/pass | %8.01f Mentities/s | %5.02fx scalar | same bits as scalar: %s | %u threads \n",
+		   "queue", 1000000.0*best_queue_seconds, (f64)entity_count / best_queue_seconds / 1000000.0,
+		   scalar_seconds / best_queue_seconds, queue_matches_scalar ? "yes" : "NO", thread_count);
+	return(0);
+}
+
+internal int
+linux_compare_u64(const void *a, const void *b)
+{
+	u64 value_a = *(u64 *)a;
+	u64 value_b = *(u64 *)b;
+	return((value_a > value_b) - (value_a < value_b));
+}
+
+// NOTE(Nader): Sorted (smaller slot, larger slot) keys, so two lists of pairs can be compared with memcmp.
+internal void
+linux_sort_pairs(SpatialHashPair *pairs, u32 pair_count, u64 *keys)
+{
+	for (u32 pair_index = 0; pair_index < pair_count; ++pair_index)
+	{
+		u64 a = pairs[pair_index].a.slot;
+		u64 b = pairs[pair_index].b.slot;
+		keys[pair_index] = (a < b) ? ((a << 32) | b) : ((b << 32) | a);
+	}
+	qsort(keys, pair_count, sizeof(u64), linux_compare_u64);
+}
+
+internal f32
+linux_random_unilateral(u32 *random_state)
+{
+	f32 result = (f32)(linux_xorshift(random_state) & 0xFFFFFF) / (f32)0xFFFFFF;
+	return(result);
+}
+
+/*
+
+NOTE(Nader): Each simd_math.c kernel at every level this machine has, over point_count
+random points. Every level runs on the same input and is checked against the scalar
+kernel's output bit for bit.
+
+*/
+#define LINUX_MATH_KERNEL_COUNT 3
+global char *linux_math_kernel_names[LINUX_MATH_KERNEL_COUNT] = {"lerp", "normalize v3", "transform"};
+
+internal void
+linux_run_math_kernel(u32 kernel, SimdLevel level, f32 **input, f32 **output, m4 *matrix, u32 count)
+{
+	switch (kernel)
+	{
+	case 0:
+	{
+		lerp_arrays(level, output[0], input[0], input[1], 0.375f, count);
+	} break;
+	case 1:
+	{
+		memcpy(output[0], input[0], (u64)count*sizeof(f32));
+		memcpy(output[1], input[1], (u64)count*sizeof(f32));
+		memcpy(output[2], input[2], (u64)count*sizeof(f32));
+		normalize_v3_arrays(level, output[0], output[1], output[2], count);
+	} break;
+	default:
+	{
+		transform_point_arrays(level, matrix, output[0], output[1], output[2], input[0], input[1], input[2], count);
+	} break;
+	}
+}
+
+internal int
+linux_run_math_benchmark(u32 point_count)
+{
+	u64 array_size = align_pow2((u64)point_count*sizeof(f32), 64);
+	// NOTE(Nader): 3 input arrays, 3 to run on and 3 holding the scalar result.
+	u8 *memory = (u8 *)mmap(0, 9*array_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED)
+	{
+		fprintf(stderr, "Could not allocate %u points \n", point_count);
+		return(1);
+	}
+	f32 *input[3];
+	f32 *output[3];
+	f32 *reference[3];
+	for (u32 array_index = 0; array_index < 3; ++array_index)
+	{
+		input[array_index] = (f32 *)(memory + (0 + array_index)*array_size);
+		output[array_index] = (f32 *)(memory + (3 + array_index)*array_size);
+		reference[array_index] = (f32 *)(memory + (6 + array_index)*array_size);
+	}
+
+	u32 random_state = 0x12345678;
+	for (u32 point_index = 0; point_index < point_count; ++point_index)
+	{
+		for (u32 array_index = 0; array_index < 3; ++array_index)
+		{
+			input[array_index][point_index] = (f32)(linux_xorshift(&random_state) % 20001) - 10000.0f;
+		}
+	}
+	// NOTE(Nader): Make sure the zero vector case is covered.
+	if (point_count)
+	{
+		input[0][0] = input[1][0] = input[2][0] = 0.0f;
+	}
+	m4 matrix = HMM_MulM4(HMM_Translate(v3(12.5f, -3.0f, 7.25f)),
+						  HMM_MulM4(HMM_Rotate_RH(0.6f, v3(0.0f, 0.0f, 1.0f)), HMM_Scale(v3(1.5f, 0.75f, 2.0f))));
+
+	SimdLevel best_level = simd_get_level();
+	SimdLevel levels[SimdLevel_Count];
+	u32 level_count = 0;
+	levels[level_count++] = SimdLevel_Scalar;
+#if SIMD_X86
+	levels[level_count++] = SimdLevel_SSE2;
+	if (best_level == SimdLevel_AVX2)
+	{
+		levels[level_count++] = SimdLevel_AVX2;
+	}
+#elif SIMD_NEON
+	levels[level_count++] = SimdLevel_NEON;
+#endif
+
+	u32 timed_pass_count = (u32)(200000000ull / ((u64)point_count + 1)) + 10;
+	printf("math benchmark: %u points, best kernel here: %s \n", point_count, simd_level_names[best_level]);
+	for (u32 kernel = 0; kernel < LINUX_MATH_KERNEL_COUNT; ++kernel)
+	{
+		u32 output_count = (kernel == 0) ? 1 : 3;
+		f64 scalar_seconds = 0.0;
+		for (u32 level_index = 0; level_index < level_count; ++level_index)
+		{
+			SimdLevel level = levels[level_index];
+			linux_run_math_kernel(kernel, level, input, output, &matrix, point_count);
+			b32 matches_scalar = true;
+			for (u32 array_index = 0; array_index < output_count; ++array_index)
+			{
+				if (level == SimdLevel_Scalar)
+				{
+					memcpy(reference[array_index], output[array_index], (u64)point_count*sizeof(f32));
+				}
+				else if (memcmp(reference[array_index], output[array_index], (u64)point_count*sizeof(f32)) != 0)
+				{
+					matches_scalar = false;
+				}
+			}
+
+			f64 best_seconds = 1e9;
+			for (u32 pass_index = 0; pass_index < timed_pass_count; ++pass_index)
+			{
+				struct timespec pass_start = linux_get_wall_clock();
+				linux_run_math_kernel(kernel, level, input, output, &matrix, point_count);
+				f64 seconds = linux_get_seconds_elapsed(pass_start, linux_get_wall_clock());
+				if (seconds < best_seconds)
+				{
+					best_seconds = seconds;
+				}
+			}
+			if (level == SimdLevel_Scalar)
+			{
+				scalar_seconds = best_seconds;
+			}
+
+			printf("%-12s %-6s  %9.03f us/pass | %8.01f Mpoints/s | %5.02fx scalar | same bits as scalar: %s \n",
+				   linux_math_kernel_names[kernel], simd_level_names[level], 1000000.0*best_seconds,
+				   (f64)point_count / best_seconds / 1000000.0, scalar_seconds / best_seconds,
+				   matches_scalar ? "yes" : "NO");
+		}
+	}
+	return(0);
+}
+
+internal int
+linux_run_broadphase_benchmark(u32 entity_count)
+{
+	u32 max_pair_count = 8*entity_count;
+	// NOTE(Nader): Components, the spatial hash at 4 cells per entity and room for 8 pairs per entity, with margin.
+	u64 memory_size = megabytes(1) + (u64)entity_count*1024;
+	void *memory = mmap(0, memory_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED)
+	{
+		fprintf(stderr, "Could not allocate %u entities \n", entity_count);
+		return(1);
+	}
+	MemoryArena arena;
+	initialize_arena(&arena, "broadphase", memory_size, memory);
+
+	EntityStore store;
+	initialize_entity_store(&store, &arena, entity_count);
+	SpatialHash hash;
+	initialize_spatial_hash(&hash, &arena, SPATIAL_HASH_CELL_SIZE, entity_count);
+	SpatialHashPair *pairs = push_array(&arena, max_pair_count, SpatialHashPair);
+	SpatialHashPair *reference_pairs = push_array(&arena, max_pair_count, SpatialHashPair);
+	u64 *keys = push_array(&arena, max_pair_count, u64);
+	u64 *reference_keys = push_array(&arena, max_pair_count, u64);
+
+	// NOTE(Nader): About one box for every two cells.
+	f32 world_size = SPATIAL_HASH_CELL_SIZE*sqrtf(2.0f*(f32)entity_count);
+	u32 random_state = 0x12345678;
+	for (u32 entity_index = 0; entity_index < entity_count; ++entity_index)
+	{
+		add_entity(&store);
+		store.position_x[entity_index] = linux_random_unilateral(&random_state)*world_size;
+		store.position_y[entity_index] = linux_random_unilateral(&random_state)*world_size;
+		store.velocity_x[entity_index] = 400.0f*linux_random_unilateral(&random_state) - 200.0f;
+		store.velocity_y[entity_index] = 400.0f*linux_random_unilateral(&random_state) - 200.0f;
+		store.size_x[entity_index] = 16.0f + 48.0f*linux_random_unilateral(&random_state);
+		store.size_y[entity_index] = 16.0f + 48.0f*linux_random_unilateral(&random_state);
+	}
+
+	SimdLevel level = simd_get_level();
+	u32 frame_count = 240;
+	f64 total_update_seconds = 0.0;
+	f64 total_pair_seconds = 0.0;
+	f64 worst_frame_seconds = 0.0;
+	u32 pair_count = 0;
+	for (u32 frame_index = 0; frame_index < frame_count; ++frame_index)
+	{
+		integrate_entities(level, &store, 1.0f / 60.0f, 0.0f);
+
+		struct timespec update_start = linux_get_wall_clock();
+		spatial_hash_update(&hash, &store);
+		struct timespec pair_start = linux_get_wall_clock();
+		pair_count = spatial_hash_find_pairs(&hash, pairs, max_pair_count);
+		struct timespec frame_end = linux_get_wall_clock();
+
+		f64 update_seconds = linux_get_seconds_elapsed(update_start, pair_start);
+		f64 pair_seconds = linux_get_seconds_elapsed(pair_start, frame_end);
+		// NOTE(Nader): The first update faults every array in, that's a load, not a frame.
+		if (frame_index > 0)
+		{
+			total_update_seconds += update_seconds;
+			total_pair_seconds += pair_seconds;
+			if (update_seconds + pair_seconds > worst_frame_seconds)
+			{
+				worst_frame_seconds = update_seconds + pair_seconds;
+			}
+		}
+	}
+	f64 measured_frame_count = (f64)(frame_count - 1);
+
+	printf("broadphase benchmark: %u boxes in a %.0f x %.0f world, %.0f unit cells, %u frames \n",
+		   entity_count, world_size, world_size, SPATIAL_HASH_CELL_SIZE, frame_count);
+	printf("spatial hash  update: %.03f ms/f (%u cells occupied) | pairs: %.03f ms/f | total: %.03f ms/f | worst: %.03f ms | "
+		   "pairs found: %u \n",
+		   1000.0*total_update_seconds / measured_frame_count, hash.cell_count,
+		   1000.0*total_pair_seconds / measured_frame_count,
+		   1000.0*(total_update_seconds + total_pair_seconds) / measured_frame_count,
+		   1000.0*worst_frame_seconds, pair_count);
+
+	// NOTE(Nader): Every pair against every other, once, on the last frame's positions.
+	struct timespec brute_start = linux_get_wall_clock();
+	u32 reference_pair_count = 0;
+	for (u32 index_a = 0; index_a < entity_count; ++index_a)
+	{
+		for (u32 index_b = index_a + 1; index_b < entity_count; ++index_b)
+		{
+			if ((store.position_x[index_a] < store.position_x[index_b] + store.size_x[index_b]) &&
+				(store.position_x[index_b] < store.position_x[index_a] + store.size_x[index_a]) &&
+				(store.position_y[index_a] < store.position_y[index_b] + store.size_y[index_b]) &&
+				(store.position_y[index_b] < store.position_y[index_a] + store.size_y[index_a]) &&
+				(reference_pair_count < max_pair_count))
+			{
+				reference_pairs[reference_pair_count].a.slot = store.dense_to_slot[index_a];
+				reference_pairs[reference_pair_count].b.slot = store.dense_to_slot[index_b];
+				++reference_pair_count;
+			}
+		}
+	}
+	f64 brute_seconds = linux_get_seconds_elapsed(brute_start, linux_get_wall_clock());
+
+	linux_sort_pairs(pairs, pair_count, keys);
+	linux_sort_pairs(reference_pairs, reference_pair_count, reference_keys);
+	b32 pairs_match = (pair_count == reference_pair_count) &&
+		(memcmp(keys, reference_keys, pair_count*sizeof(u64)) == 0);
+	printf("O(n^2) pairs  %.03f ms/f | %.01fx slower | same pairs: %s \n", 1000.0*brute_seconds,
+		   brute_seconds*measured_frame_count / (total_update_seconds + total_pair_seconds), pairs_match ? "yes" : "NO");
+
+	u32 query_count = 10000;
+	EntityHandle *results = push_array(&arena, entity_count, EntityHandle);
+	u64 total_result_count = 0;
+	b32 queries_match = true;
+	struct timespec query_start = linux_get_wall_clock();
+	for (u32 query_index = 0; query_index < query_count; ++query_index)
+	{
+		v2 min = v2(linux_random_unilateral(&random_state)*world_size, linux_random_unilateral(&random_state)*world_size);
+		v2 max = v2(min.X + 256.0f, min.Y + 256.0f);
+		u32 result_count = spatial_hash_query_aabb(&hash, min, max, results, entity_count);
+		total_result_count += result_count;
+		// NOTE(Nader): Spot check a few against every box, outside the timing would be cleaner but it is 1%.
+		if (query_index < 100)
+		{
+			u32 reference_count = 0;
+			for (u32 index = 0; index < entity_count; ++index)
+			{
+				if ((store.position_x[index] < max.X) && (min.X < store.position_x[index] + store.size_x[index]) &&
+					(store.position_y[index] < max.Y) && (min.Y < store.position_y[index] + store.size_y[index]))
+				{
+					++reference_count;
+				}
+			}
+			queries_match = queries_match && (reference_count == result_count);
+		}
+	}
+	f64 query_seconds = linux_get_seconds_elapsed(query_start, linux_get_wall_clock());
+	printf("aabb queries  256 x 256: %.03f us/query | %.02f hits/query | same as O(n): %s \n",
+		   1000000.0*query_seconds / (f64)query_count, (f64)total_result_count / (f64)query_count,
+		   queries_match ? "yes" : "NO");
+
+	b32 rays_match = true;
+	u32 hit_count = 0;
+	f32 max_t = 4096.0f;
+	struct timespec ray_start = linux_get_wall_clock();
+	for (u32 ray_index = 0; ray_index < query_count; ++ray_index)
+	{
+		v2 origin = v2(linux_random_unilateral(&random_state)*world_size, linux_random_unilateral(&random_state)*world_size);
+		f32 angle = 2.0f*HMM_PI32*linux_random_unilateral(&random_state);
+		v2 direction = v2(HMM_CosF(angle), HMM_SinF(angle));
+		f32 hit_t;
+		EntityHandle hit = spatial_hash_raycast(&hash, origin, direction, max_t, &hit_t);
+		hit_count += (hit.generation != 0);
+		if (ray_index < 100)
+		{
+			f32 reference_t = max_t;
+			u32 reference_hit = ENTITY_INDEX_NONE;
+			v2 inverse_direction = v2(1.0f / direction.X, 1.0f / direction.Y);
+			for (u32 index = 0; index < entity_count; ++index)
+			{
+				f32 t = ray_box_entry(origin, direction, inverse_direction, store.position_x[index], store.position_y[index],
+									  store.position_x[index] + store.size_x[index],
+									  store.position_y[index] + store.size_y[index]);
+				if ((t >= 0.0f) && (t < reference_t))
+				{
+					reference_t = t;
+					reference_hit = index;
+				}
+			}
+			if (reference_hit == ENTITY_INDEX_NONE)
+			{
+				rays_match = rays_match && (hit.generation == 0);
+			}
+			else
+			{
+				rays_match = rays_match && (hit.slot == store.dense_to_slot[reference_hit]) && (reference_t == hit_t);
+			}
+		}
+	}
+	f64 ray_seconds = linux_get_seconds_elapsed(ray_start, linux_get_wall_clock());
+	printf("raycasts      %.0f units: %.03f us/ray | %.01f%% hit | same as O(n): %s \n", max_t,
+		   1000000.0*ray_seconds / (f64)query_count, 100.0*(f64)hit_count / (f64)query_count,
+		   rays_match ? "yes" : "NO");
+
+	/*
+	   NOTE(Nader): Axis aligned rays from just outside a box, running along its edges, so
+	   they sit exactly on that box's slab planes with a zero direction component. Along one
+	   axis the reference needs no slab test at all, so it doesn't share ray_box_entry's.
+	   Only t is compared, an origin inside several boxes hits them all at 0.
+	*/
+	local_persist f32 edge_directions[4][2] = {{1.0f, 0.0f}, {0.0f, 1.0f}, {-1.0f, 0.0f}, {0.0f, -1.0f}};
+	b32 edge_rays_match = true;
+	u32 edge_ray_count = 0;
+	for (u32 box_index = 0; (box_index < entity_count) && (box_index < 100); ++box_index)
+	{
+		for (u32 direction_index = 0; direction_index < array_count(edge_directions); ++direction_index)
+		{
+			v2 direction = v2(edge_directions[direction_index][0], edge_directions[direction_index][1]);
+			// NOTE(Nader): Rays going up or right start off the bottom left corner, the others off the top right.
+			v2 corner = v2(store.position_x[box_index], store.position_y[box_index]);
+			if ((direction.X + direction.Y) < 0.0f)
+			{
+				corner = v2(corner.X + store.size_x[box_index], corner.Y + store.size_y[box_index]);
+			}
+			v2 origin = v2(corner.X - 16.0f*direction.X, corner.Y - 16.0f*direction.Y);
+			f32 hit_t;
+			EntityHandle hit = spatial_hash_raycast(&hash, origin, direction, max_t, &hit_t);
+
+			b32 along_x = (direction.Y == 0.0f);
+			b32 forward = (direction.X + direction.Y) > 0.0f;
+			f32 origin_along = along_x ? origin.X : origin.Y;
+			f32 origin_across = along_x ? origin.Y : origin.X;
+			f32 reference_t = max_t;
+			b32 reference_hit = false;
+			for (u32 index = 0; index < entity_count; ++index)
+			{
+				f32 along_min = along_x ? store.position_x[index] : store.position_y[index];
+				f32 along_max = along_min + (along_x ? store.size_x[index] : store.size_y[index]);
+				f32 across_min = along_x ? store.position_y[index] : store.position_x[index];
+				f32 across_max = across_min + (along_x ? store.size_y[index] : store.size_x[index]);
+				f32 near_t = forward ? (along_min - origin_along) : (origin_along - along_max);
+				f32 far_t = forward ? (along_max - origin_along) : (origin_along - along_min);
+				f32 t = HMM_MAX(near_t, 0.0f);
+				if ((origin_across >= across_min) && (origin_across <= across_max) && (far_t >= 0.0f) && (t < reference_t))
+				{
+					reference_t = t;
+					reference_hit = true;
+				}
+			}
+			edge_rays_match = edge_rays_match && ((hit.generation != 0) == reference_hit) &&
+				(!reference_hit || (hit_t == reference_t));
+			++edge_ray_count;
+		}
+	}
+	printf("edge raycasts %u axis aligned, along box edges | same as O(n): %s \n", edge_ray_count,
+		   edge_rays_match ? "yes" : "NO");
+
+	return(pairs_match && queries_match && rays_match && edge_rays_match ? 0 : 1);
+}
+
+int
+main(int argc, char **argv)
+{
+	LinuxState linux_state = { 0 };
+
+	u32 frame_count = 10000;
+	int game_update_hz = 60;
+	int render_hz = 0;
+	char *script_filepath = 0;
+	char *dump_filepath = 0;
+	b32 render = true;
+	b32 use_huge_pages = false;
+	char *record_filepath = 0;
+	char *playback_filepath = 0;
+	b32 pace = false;
+	char *trace_filepath = 0;
+	int thread_count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	u32 integrate_benchmark_count = 0;
+	u32 broadphase_benchmark_count = 0;
+	u32 math_benchmark_count = 0;
+	for (int arg_index = 1; arg_index < argc; ++arg_index)
+	{
+		if (strcmp(argv[arg_index], "-frames") == 0 && arg_index + 1 < argc)
+		{
+			frame_count = (u32)strtoul(argv[++arg_index], 0, 10);
+		}
+		else if (strcmp(argv[arg_index], "-hz") == 0 && arg_index + 1 < argc)
+		{
+			game_update_hz = atoi(argv[++arg_index]);
+		}
+		else if (strcmp(argv[arg_index], "-render_hz") == 0 && arg_index + 1 < argc)
+		{
+			render_hz = atoi(argv[++arg_index]);
+		}
+		else if (strcmp(argv[arg_index], "-script") == 0 && arg_index + 1 < argc)
+		{
+			script_filepath = argv[++arg_index];
+		}
+		else if (strcmp(argv[arg_index], "-dump") == 0 && arg_index + 1 < argc)
+		{
+			dump_filepath = argv[++arg_index];
+		}
+		else if (strcmp(argv[arg_index], "-norender") == 0)
+		{
+			render = false;
+		}
+		else if (strcmp(argv[arg_index], "-hugepages") == 0)
+		{
+			use_huge_pages = true;
+		}
+		else if (strcmp(argv[arg_index], "-record") == 0 && arg_index + 1 < argc)
+		{
+			record_filepath = argv[++arg_index];
+		}
+		else if (strcmp(argv[arg_index], "-playback") == 0 && arg_index + 1 < argc)
+		{
+			playback_filepath = argv[++arg_index];
+		}
+		else if (strcmp(argv[arg_index], "-pace") == 0)
+		{
+			pace = true;
+		}
+		else if (strcmp(argv[arg_index], "-trace") == 0 && arg_index + 1 < argc)
+		{
+			trace_filepath = argv[++arg_index];
+		}
+		else if (strcmp(argv[arg_index], "-threads") == 0 && arg_index + 1 < argc)
+		{
+			thread_count = atoi(argv[++arg_index]);
+		}
+		else if (strcmp(argv[arg_index], "-integrate_benchmark") == 0 && arg_index + 1 < argc)
+		{
+			integrate_benchmark_count = (u32)strtoul(argv[++arg_index], 0, 10);
+		}
+		else if (strcmp(argv[arg_index], "-broadphase_benchmark") == 0 && arg_index + 1 < argc)
+		{
+			broadphase_benchmark_count = (u32)strtoul(argv[++arg_index], 0, 10);
+		}
+		else if (strcmp(argv[arg_index], "-math_benchmark") == 0 && arg_index + 1 < argc)
+		{
+			math_benchmark_count = (u32)strtoul(argv[++arg_index], 0, 10);
+		}
+		else
+		{
+			fprintf(stderr, "Usage: %s [-frames N] [-hz N] [-render_hz N] [-script path] [-norender] [-dump path.ppm] "
+					"[-hugepages] [-record path] [-playback path] [-pace] [-trace path.json] [-threads N] \n", argv[0]);
+			fprintf(stderr, "       %s -integrate_benchmark entity_count \n", argv[0]);
+			fprintf(stderr, "       %s -broadphase_benchmark entity_count \n", argv[0]);
+			fprintf(stderr, "       %s -math_benchmark point_count \n", argv[0]);
+			return(1);
+		}
+	}
+	if (render_hz == 0)
+	{
+		render_hz = game_update_hz;
+	}
+	if (frame_count == 0 || game_update_hz <= 0 || render_hz <= 0 || thread_count <= 0)
+	{
+		fprintf(stderr, "-frames, -hz, -render_hz and -threads must be positive \n");
+		return(1);
+	}
+	if (thread_count > WORK_QUEUE_MAX_THREADS)
+	{
+		thread_count = WORK_QUEUE_MAX_THREADS;
+	}
+
+	// WORK QUEUE SETUP
+	PlatformWorkQueue *work_queue = (PlatformWorkQueue *)mmap(0, sizeof(PlatformWorkQueue), PROT_READ | PROT_WRITE,
+															  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if ((work_queue == MAP_FAILED) ||
+		!linux_make_work_queue(work_queue, (u32)thread_count, &linux_state.work_queue_semaphore,
+							   linux_state.work_queue_startups))
+	{
+		fprintf(stderr, "Could not start the work queue \n");
+		return(1);
+	}
+
+	PlatformWorkQueue *low_priority_queue = (PlatformWorkQueue *)mmap(0, sizeof(PlatformWorkQueue),
+																	  PROT_READ | PROT_WRITE,
+																	  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if ((low_priority_queue == MAP_FAILED) ||
+		!linux_make_work_queue(low_priority_queue, LOW_PRIORITY_QUEUE_THREAD_COUNT,
+							   &linux_state.low_priority_queue_semaphore, linux_state.low_priority_queue_startups))
+	{
+		fprintf(stderr, "Could not start the low priority work queue \n");
+		return(1);
+	}
+
+	if (integrate_benchmark_count)
+	{
+		return(linux_run_integrate_benchmark(work_queue, (u32)thread_count, integrate_benchmark_count));
+	}
+	if (broadphase_benchmark_count)
+	{
+		return(linux_run_broadphase_benchmark(broadphase_benchmark_count));
+	}
+	if (math_benchmark_count)
+	{
+		return(linux_run_math_benchmark(math_benchmark_count));
+	}
+
+	LinuxInputScript script = { 0 };
+	if (script_filepath)
+	{
+		FileReadResults script_file = read_file_to_memory(script_filepath);
+		if (!script_file.contents)
+		{
+			fprintf(stderr, "Could not read input script %s \n", script_filepath);
+			return(1);
+		}
+		b32 parsed = linux_parse_input_script(&script, (char *)script_file.contents);
+		free_file_memory(&script_file);
+		if (!parsed)
+		{
+			fprintf(stderr, "Could not parse input script %s \n", script_filepath);
+			return(1);
+		}
+	}
+	else
+	{
+		linux_default_input_script(&script);
+	}
+
+	// ALLOCATE GAME MEMORY
+	GameMemory game_memory = { 0 };
+	game_memory.permanent_storage_size = megabytes(64);
+	game_memory.transient_storage_size = gigabytes(1);
+	if (!linux_allocate_game_memory(&linux_state, game_memory.permanent_storage_size +
+									game_memory.transient_storage_size, use_huge_pages))
+	{
+		fprintf(stderr, "Could not allocate %llu bytes of game memory \n",
+				(unsigned long long)linux_state.total_size);
+		return(1);
+	}
+	game_memory.permanent_storage = linux_state.game_memory_block;
+	game_memory.transient_storage = ((u8 *)game_memory.permanent_storage +
+									 game_memory.permanent_storage_size);
+
+	f64 *frame_seconds = (f64 *)mmap(0, frame_count * sizeof(f64), PROT_READ | PROT_WRITE,
+									 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (frame_seconds == MAP_FAILED)
+	{
+		fprintf(stderr, "Could not allocate frame timings \n");
+		return(1);
+	}
+
+	// GAME CODE SETUP
+	linux_get_exe_filepath(&linux_state);
+	char game_library_filepath[4096];
+	char temp_game_library_filepath_prefix[4096];
+	char game_library_lock_filepath[4096];
+	linux_build_exe_path_filepath(&linux_state, "blowback_game.so",
+								  game_library_filepath, sizeof(game_library_filepath));
+	linux_build_exe_path_filepath(&linux_state, "blowback_game_loaded",
+								  temp_game_library_filepath_prefix, sizeof(temp_game_library_filepath_prefix));
+	linux_build_exe_path_filepath(&linux_state, "blowback_game.lock",
+								  game_library_lock_filepath, sizeof(game_library_lock_filepath));
+
+	// ASSET PACK SETUP
+	char asset_pack_filepath[4096];
+	linux_build_exe_path_filepath(&linux_state, "blowback.pack", asset_pack_filepath, sizeof(asset_pack_filepath));
+	AssetPack asset_pack = { 0 };
+	struct timespec map_start_counter = linux_get_wall_clock();
+	linux_map_asset_pack(asset_pack_filepath, &asset_pack);
+	f64 asset_pack_map_seconds = linux_get_seconds_elapsed(map_start_counter, linux_get_wall_clock());
+
+	LinuxGameCode game = {0};
+	linux_load_game_code(&game, game_library_filepath, temp_game_library_filepath_prefix);
+	if (!game.is_valid)
+	{
+		fprintf(stderr, "Could not load game code from %s: %s \n", game_library_filepath, dlerror());
+		return(1);
+	}
+
+	// PROFILER SETUP
+	Profiler *profiler = (Profiler *)mmap(0, sizeof(Profiler), PROT_READ | PROT_WRITE,
+										  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (profiler == MAP_FAILED)
+	{
+		fprintf(stderr, "Could not allocate the profiler \n");
+		return(1);
+	}
+	profiler_init(profiler);
+	global_profiler = profiler;
+	game_memory.profiler = profiler;
+	game_memory.work_queue = work_queue;
+	game_memory.work_queue_thread_count = (u32)thread_count;
+	game_memory.platform_add_entry = linux_add_entry;
+	game_memory.platform_complete_all_work = linux_complete_all_work;
+	game_memory.low_priority_queue = low_priority_queue;
+	game_memory.platform_read_entire_file = linux_read_entire_file;
+	game_memory.asset_pack = &asset_pack;
+
+	// RENDERER SETUP
+	RenderCommands render_commands = { 0 };
+	render_commands.width = WINDOW_WIDTH;
+	render_commands.height = WINDOW_HEIGHT;
+
+	SoftwareRenderer software_renderer = { 0 };
+	SoftwareFramebuffer *framebuffer = &software_renderer.framebuffer;
+	framebuffer->width = WINDOW_WIDTH;
+	framebuffer->height = WINDOW_HEIGHT;
+	framebuffer->pitch = WINDOW_WIDTH;
+	framebuffer->pixels = (u32 *)mmap(0, framebuffer->pitch*framebuffer->height*sizeof(u32),
+									  PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (framebuffer->pixels == MAP_FAILED)
+	{
+		fprintf(stderr, "Could not allocate the renderer \n");
+		return(1);
+	}
+
+	// INPUT SETUP
+	GameInput input[2] = {0};
+	GameInput *new_input = &input[0];
+	GameInput *old_input = &input[1];
+
+	// REPLAY SETUP
+	FILE *recording_file = 0;
+	GameInput last_recorded_input = {0};
+	if (record_filepath)
+	{
+		recording_file = fopen(record_filepath, "wb");
+		if (!recording_file)
+		{
+			fprintf(stderr, "Could not open %s for recording \n", record_filepath);
+			return(1);
+		}
+		ReplayHeader header;
+		replay_fill_header(&header, &game_memory);
+		fwrite(&header, sizeof(header), 1, recording_file);
+		fwrite(game_memory.permanent_storage, header.snapshot_size, 1, recording_file);
+	}
+
+	ReplayPlayback playback = {0};
+	FileReadResults replay_file = {0};
+	u64 first_loop_state_hash = 0;
+	u32 mismatched_loop_count = 0;
+	if (playback_filepath)
+	{
+		replay_file = read_file_to_memory(playback_filepath);
+		if (!replay_file.contents ||
+			!replay_begin_playback(&playback, replay_file.contents, replay_file.contents_size, &game_memory))
+		{
+			fprintf(stderr, "Could not play back %s \n", playback_filepath);
+			return(1);
+		}
+		replay_restore_snapshot(&playback, &game_memory);
+	}
+
+	// FRAME PACING SETUP
+	f64 target_seconds_per_frame = 1.0 / (f64)render_hz;
+	// NOTE(Nader): Counted in 1 / (game_update_hz*render_hz) second ticks so no step is ever
+	// lost or gained to rounding: a frame is game_update_hz ticks, a simulate step render_hz.
+	u64 unsimulated_ticks = 0;
+	u32 simulate_step_count = 0;
+	FramePacer pacer;
+	frame_pacer_init(&pacer, target_seconds_per_frame);
+
+	// GAME LOOP
+	struct timespec start_counter = linux_get_wall_clock();
+	u64 start_cycle_count = __rdtsc();
+	f64 start_cpu_seconds = linux_get_process_cpu_seconds();
+	struct timespec last_frame_end_counter = start_counter;
+	struct timespec last_profiler_counter = start_counter;
+	struct timespec frame_deadline = linux_add_seconds(start_counter, target_seconds_per_frame);
+	for (u32 frame_index = 0; frame_index < frame_count; ++frame_index)
+	{
+		if (linux_game_code_changed(&game, game_library_filepath, game_library_lock_filepath))
+		{
+			// NOTE(Nader): Queued work points at code in the old library.
+			linux_complete_all_work(low_priority_queue);
+			linux_unload_game_code(&game);
+			linux_load_game_code(&game, game_library_filepath, temp_game_library_filepath_prefix);
+		}
+
+		// NOTE(Nader): Input is synthetic and cheap here, so the frame time is the game and the renderer.
+		struct timespec frame_start_counter = linux_get_wall_clock();
+
+		// SIMULATE
+		unsimulated_ticks += (u64)game_update_hz;
+		while (unsimulated_ticks >= (u64)render_hz)
+		{
+			unsimulated_ticks -= (u64)render_hz;
+
+			BEGIN_TIMED_BLOCK(process_input);
+			if (playback.base)
+			{
+				if (!replay_playback_input(&playback, new_input))
+				{
+					u64 state_hash = hash_memory(game_memory.permanent_storage, game_memory.permanent_storage_size);
+					if (playback.loop_count == 0)
+					{
+						first_loop_state_hash = state_hash;
+					}
+					else if (state_hash != first_loop_state_hash)
+					{
+						++mismatched_loop_count;
+					}
+					++playback.loop_count;
+
+					replay_restore_snapshot(&playback, &game_memory);
+					if (!replay_playback_input(&playback, new_input))
+					{
+						fprintf(stderr, "Replay %s has no frames \n", playback_filepath);
+						return(1);
+					}
+				}
+			}
+			else
+			{
+				new_input->dt_for_frame = 1.0f / (f32)game_update_hz;
+				linux_process_input_script(&script, &old_input->controllers[0], &new_input->controllers[0]);
+			}
+
+			if (recording_file)
+			{
+				u8 encoded_input[REPLAY_MAX_ENCODED_INPUT_SIZE];
+				u32 encoded_size = replay_encode_input(new_input, &last_recorded_input, encoded_input);
+				fwrite(encoded_input, encoded_size, 1, recording_file);
+				last_recorded_input = *new_input;
+			}
+			END_TIMED_BLOCK(process_input);
+
+			game.simulate(&game_memory, new_input);
+			++simulate_step_count;
+
+			GameInput *temp = new_input;
+			new_input = old_input;
+			old_input = temp;
+		}
+
+		// RENDER
+		f32 interpolation = (f32)unsimulated_ticks / (f32)render_hz;
+		game.render(&game_memory, interpolation, (f32)target_seconds_per_frame, &render_commands);
+		if (render)
+		{
+			software_render_commands(&software_renderer, &render_commands);
+		}
+
+		if (pace)
+		{
+			b32 missed = false;
+			TIMED_BLOCK(wait_for_frame_deadline)
+			{
+				missed = !linux_wait_for_frame_deadline(&pacer, frame_deadline);
+			}
+			struct timespec frame_end_counter = linux_get_wall_clock();
+			frame_seconds[frame_index] = linux_get_seconds_elapsed(last_frame_end_counter, frame_end_counter);
+			frame_pacer_end_frame(&pacer, frame_seconds[frame_index], missed);
+
+			last_frame_end_counter = frame_end_counter;
+			frame_deadline = linux_add_seconds(missed ? frame_end_counter : frame_deadline,
+											   target_seconds_per_frame);
+		}
+		else
+		{
+			frame_seconds[frame_index] = linux_get_seconds_elapsed(frame_start_counter, linux_get_wall_clock());
+		}
+
+		struct timespec profiler_counter = linux_get_wall_clock();
+		profiler_end_frame(profiler, linux_get_seconds_elapsed(last_profiler_counter, profiler_counter));
+		last_profiler_counter = profiler_counter;
+	}
+	u64 cycles_elapsed = __rdtsc() - start_cycle_count;
+	f64 total_seconds = linux_get_seconds_elapsed(start_counter, linux_get_wall_clock());
+	f64 cpu_seconds = linux_get_process_cpu_seconds() - start_cpu_seconds;
+
+	if (recording_file)
+	{
+		b32 recorded = (ferror(recording_file) == 0);
+		if ((fclose(recording_file) != 0) || !recorded)
+		{
+			fprintf(stderr, "Could not write recording %s \n", record_filepath);
+			return(1);
+		}
+	}
+
+	// REPORT
+	qsort(frame_seconds, frame_count, sizeof(f64), compare_f64);
+	printf("frames: %u | total: %.03f s | fps: %.01f | mcycles/f: %.03f \n",
+		   frame_count, total_seconds, (f64)frame_count / total_seconds,
+		   (f64)cycles_elapsed / (f64)frame_count / 1000000.0);
+	printf("us/f  p50: %.03f | p90: %.03f | p99: %.03f | p99.9: %.03f | max: %.03f \n",
+		   1000000.0*linux_percentile(frame_seconds, frame_count, 0.50),
+		   1000000.0*linux_percentile(frame_seconds, frame_count, 0.90),
+		   1000000.0*linux_percentile(frame_seconds, frame_count, 0.99),
+		   1000000.0*linux_percentile(frame_seconds, frame_count, 0.999),
+		   1000000.0*frame_seconds[frame_count - 1]);
+	printf("cpu: %.01f%% of one core \n", 100.0*cpu_seconds / total_seconds);
+	printf("simulate  steps: %u at %d hz | frames drawn at %d hz \n", simulate_step_count, game_update_hz, render_hz);
+	if (pace)
+	{
+		printf("pacer  missed: %llu | worst error: %.03f ms | worst oversleep: %.03f ms | spin margin: %.03f ms \n",
+			   (unsigned long long)pacer.missed_frame_count, 1000.0*pacer.worst_frame_error_seconds,
+			   1000.0*pacer.worst_oversleep_seconds, 1000.0*pacer.spin_margin_seconds);
+		printf("pacer  slept: %.01f%% | spun: %.01f%% \n",
+			   100.0*pacer.total_sleep_seconds / total_seconds, 100.0*pacer.total_spin_seconds / total_seconds);
+	}
+
+	GameState *game_state = (GameState *)game_memory.permanent_storage;
+	EntityStore *entities = &game_state->entities;
+	u32 player_index = entities->slot_to_dense[game_state->player.slot];
+	printf("player: (%.01f, %.01f) | entities: %u \n", entities->position_x[player_index],
+		   entities->position_y[player_index], entities->count);
+	if (playback.base)
+	{
+		printf("replay: %u complete loops | every loop ended in the same state: %s \n",
+			   playback.loop_count, (mismatched_loop_count == 0) ? "yes" : "NO");
+	}
+	printf("state hash: %016llx \n", (unsigned long long)hash_memory(game_memory.permanent_storage,
+																	  game_memory.permanent_storage_size));
+	printf("game code: loaded %u times \n", game.load_count);
+	printf("work queue  threads: %d | steals: %u | overflows: %u \n", thread_count,
+		   work_queue->steal_count, work_queue->overflow_count);
+	printf("game memory: %p, %.01f MB, %s \n", linux_state.game_memory_block,
+		   (f64)linux_state.total_size / (f64)megabytes(1), linux_state.page_backing);
+	printf("last frame  entries: %u | instances: %u | static instances: %u | batches: %u \n",
+		   render_commands.entry_count, render_commands.instance_count, render_commands.static_instance_count,
+		   render_commands.batch_count);
+	TransientState *tran_state = (TransientState *)game_memory.transient_storage;
+	Tilemap *tilemap = &tran_state->tilemap;
+	printf("tilemap  visible chunks: %u | resident: %u of %u | paged in: %u | evicted: %u | bakes: %u \n",
+		   tilemap->visible_chunk_count, tilemap->resident_chunk_count, TILEMAP_MAX_RESIDENT_CHUNKS,
+		   tilemap->page_in_count, tilemap->eviction_count, tilemap->bake_count);
+	if (asset_pack.base)
+	{
+		printf("asset pack  entries: %u | %.01f MB mapped in %.03f ms \n", asset_pack.entry_count,
+			   (f64)asset_pack.size / (f64)megabytes(1), 1000.0*asset_pack_map_seconds);
+	}
+	else
+	{
+		printf("asset pack  none, loading loose files \n");
+	}
+	Assets *assets = &tran_state->assets;
+	printf("assets  bitmaps loaded: %u | failed: %u | most uploaded in a frame: %.01f KB of %.01f KB \n",
+		   assets->loaded_count, assets->failed_count, (f64)assets->max_upload_bytes_in_a_frame / 1024.0,
+		   (f64)ASSET_UPLOAD_BYTES_PER_FRAME / 1024.0);
+	printf("assets  task arenas: %u x %.01f KB \n", ASSET_TASK_COUNT, (f64)assets->task_arena_size / 1024.0);
+	Camera *camera = &tran_state->camera;
+	printf("camera  matrices rebuilt: %u of %u frames \n", camera->rebuild_count, camera->update_count);
+	SpatialHash *spatial_hash = &game_state->spatial_hash;
+	printf("spatial hash  cells occupied: %u of %u | boxes: %u \n",
+		   spatial_hash->cell_count, spatial_hash->max_cell_count, spatial_hash->box_count);
+
+	MemoryArena *arenas[] =
+	{
+		&game_state->permanent_arena,
+		&tran_state->transient_arena,
+		&tran_state->frame_arena,
+	};
+	for (u32 arena_index = 0; arena_index < array_count(arenas); ++arena_index)
+	{
+		MemoryArena *arena = arenas[arena_index];
+		printf("arena %-10s high water: %8.03f MB of %9.03f MB \n", arena->name,
+			   (f64)arena->high_water_mark / (f64)megabytes(1), (f64)arena->size / (f64)megabytes(1));
+	}
+
+	char profiler_summary[8192];
+	profiler_format_summary(profiler, profiler_summary, sizeof(profiler_summary));
+	printf("profiler blocks, dropped events: %u \n%s", profiler_dropped_event_count(profiler), profiler_summary);
+
+	if (trace_filepath)
+	{
+		FILE *trace_file = fopen(trace_filepath, "wb");
+		if (!trace_file)
+		{
+			fprintf(stderr, "Could not open %s \n", trace_filepath);
+			return(1);
+		}
+		profiler_write_chrome_trace(profiler, linux_write_to_file, trace_file);
+		b32 traced = (ferror(trace_file) == 0);
+		if ((fclose(trace_file) != 0) || !traced)
+		{
+			fprintf(stderr, "Could not write %s \n", trace_filepath);
+			return(1);
+		}
+	}
+
+	if (dump_filepath)
+	{
+		if (!render)
+		{
+			software_render_commands(&software_renderer, &render_commands);
+		}
+		if (!linux_write_framebuffer_ppm(framebuffer, dump_filepath))
+		{
+			fprintf(stderr, "Could not write %s \n", dump_filepath);
+			return(1);
+		}
+	}
+
+	return(0);
+}
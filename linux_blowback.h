@@ -0,0 +1,55 @@
+#pragma once
+
+typedef struct LinuxThreadStartup
+{
+    PlatformWorkQueue *queue;
+    u32 thread_index;
+} LinuxThreadStartup;
+
+typedef struct LinuxState
+{
+    u64 total_size;
+    void *game_memory_block;
+    char *page_backing;
+
+    char exe_filepath[4096];
+    char *one_past_last_exe_filepath_slash;
+
+    sem_t work_queue_semaphore;
+    LinuxThreadStartup work_queue_startups[WORK_QUEUE_MAX_THREADS];
+    sem_t low_priority_queue_semaphore;
+    LinuxThreadStartup low_priority_queue_startups[LOW_PRIORITY_QUEUE_THREAD_COUNT];
+} LinuxState;
+
+typedef struct LinuxGameCode
+{
+    void *library;
+    struct timespec library_last_write_time;
+    u32 load_count;
+
+    // NOTE(Nader): Points at a stub that does nothing while no library is loaded.
+    game_simulate_function *simulate;
+    game_render_function *render;
+    b32 is_valid;
+} LinuxGameCode;
+
+/*
+
+NOTE(Nader): A scripted input step holds a set of buttons down for frame_count frames.
+button_mask has one bit per entry in GameControllerInput.buttons.
+
+*/
+typedef struct LinuxScriptStep
+{
+    u32 frame_count;
+    u32 button_mask;
+} LinuxScriptStep;
+
+typedef struct LinuxInputScript
+{
+    u32 step_count;
+    LinuxScriptStep steps[256];
+
+    u32 step_index;
+    u32 frames_into_step;
+} LinuxInputScript;
@@ -0,0 +1,136 @@
+#pragma once
+
+/*
+
+NOTE(Nader): Linear arena allocator over the blocks in GameMemory. Nothing on the hot
+path calls malloc, everything is pushed onto an arena and freed all at once, either by
+resetting the arena (per frame) or by rolling back to a TemporaryMemory checkpoint.
+
+Memory pushed onto an arena is NOT cleared. Permanent storage starts out zeroed by the
+platform, transient storage gets reused every frame.
+
+high_water_mark is the most that has ever been in use at once, so after a play session
+it tells us how much of its budget each arena really needed.
+
+*/
+
+typedef struct MemoryArena
+{
+    // NOTE(Nader): Stored inline, a pointer to a string literal would differ between runs
+    // and break snapshots of game memory.
+    char name[16];
+    u64 size;
+    u8 *base;
+    u64 used;
+    u64 high_water_mark;
+
+    u32 temp_count;
+} MemoryArena;
+
+typedef struct TemporaryMemory
+{
+    MemoryArena *arena;
+    u64 used;
+} TemporaryMemory;
+
+// NOTE(Nader): Default alignment is 16 so anything holding v4 or m4 (SSE registers) is safe.
+#define DEFAULT_ARENA_ALIGNMENT 16
+
+#define push_struct(arena, type) (type *)push_size_(arena, sizeof(type), DEFAULT_ARENA_ALIGNMENT)
+#define push_array(arena, count, type) (type *)push_size_(arena, (count)*sizeof(type), DEFAULT_ARENA_ALIGNMENT)
+#define push_size(arena, size) push_size_(arena, size, DEFAULT_ARENA_ALIGNMENT)
+#define push_size_aligned(arena, size, alignment) push_size_(arena, size, alignment)
+
+internal void
+initialize_arena(MemoryArena *arena, char *name, u64 size, void *base)
+{
+    u32 name_length = 0;
+    for (; name[name_length] && (name_length < (sizeof(arena->name) - 1)); ++name_length)
+    {
+        arena->name[name_length] = name[name_length];
+    }
+    arena->name[name_length] = 0;
+    arena->size = size;
+    arena->base = (u8 *)base;
+    arena->used = 0;
+    arena->high_water_mark = 0;
+    arena->temp_count = 0;
+}
+
+internal u64
+get_alignment_offset(MemoryArena *arena, u64 alignment)
+{
+    u64 result = 0;
+    u64 next_address = (u64)(arena->base + arena->used);
+    u64 alignment_mask = alignment - 1;
+    if (next_address & alignment_mask)
+    {
+        result = alignment - (next_address & alignment_mask);
+    }
+    return(result);
+}
+
+internal u64
+get_arena_size_remaining(MemoryArena *arena, u64 alignment)
+{
+    u64 result = arena->size - (arena->used + get_alignment_offset(arena, alignment));
+    return(result);
+}
+
+internal void *
+push_size_(MemoryArena *arena, u64 size, u64 alignment)
+{
+    asserts((alignment & (alignment - 1)) == 0);
+    u64 alignment_offset = get_alignment_offset(arena, alignment);
+    u64 effective_size = size + alignment_offset;
+    asserts((arena->used + effective_size) <= arena->size);
+
+    void *result = arena->base + arena->used + alignment_offset;
+    arena->used += effective_size;
+    if (arena->used > arena->high_water_mark)
+    {
+        arena->high_water_mark = arena->used;
+    }
+    return(result);
+}
+
+// NOTE(Nader): Carves a child arena out of arena so a subsystem gets its own budget and stats.
+internal void
+sub_arena(MemoryArena *result, MemoryArena *arena, char *name, u64 size)
+{
+    void *base = push_size(arena, size);
+    initialize_arena(result, name, size, base);
+}
+
+internal void
+reset_arena(MemoryArena *arena)
+{
+    asserts(arena->temp_count == 0);
+    arena->used = 0;
+}
+
+internal TemporaryMemory
+begin_temporary_memory(MemoryArena *arena)
+{
+    TemporaryMemory result;
+    result.arena = arena;
+    result.used = arena->used;
+    ++arena->temp_count;
+    return(result);
+}
+
+internal void
+end_temporary_memory(TemporaryMemory temp_memory)
+{
+    MemoryArena *arena = temp_memory.arena;
+    asserts(arena->used >= temp_memory.used);
+    asserts(arena->temp_count > 0);
+    arena->used = temp_memory.used;
+    --arena->temp_count;
+}
+
+internal void
+check_arena(MemoryArena *arena)
+{
+    asserts(arena->temp_count == 0);
+}
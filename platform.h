@@ -24,10 +24,13 @@ typedef double f64;
 
 typedef HMM_Mat4 m4;
 typedef HMM_Mat3 m3;
+typedef HMM_Vec4 v4;
 typedef HMM_Vec3 v3;
 typedef HMM_Vec2 v2;
 
+#define v4(x, y, z, w) HMM_V4(x, y, z, w)
 #define v3(x, y, z) HMM_V3(x, y, z)
+#define v2(x, y) HMM_V2(x, y)
 #define m4_diagonal(value) HMM_M4D(value)
 
 #define internal static
@@ -40,6 +43,8 @@ typedef HMM_Vec2 v2;
 #define terabytes(value) (gigabytes(value)*1024LL)
 
 #define array_count(arr) (sizeof(arr) / sizeof((arr)[0]))
+#define align_pow2(value, alignment) (((value) + ((alignment) - 1)) & ~((alignment) - 1))
+#define align16(value) align_pow2(value, 16)
 
 #if BLOWBACK_SLOW
 #define asserts(expression) if(!(expression)) { *(int *)0 = 0; }
@@ -47,3 +52,105 @@ typedef HMM_Vec2 v2;
 #define asserts(expression)
 #endif
 
+
+/*
+
+NOTE(Nader): Atomics and thread local storage. The barriers only stop the compiler (and
+on weaker memory models the CPU) from moving writes or reads across them; x86 already
+keeps stores in order with each other. complete_previous_writes_before_future_reads is
+the one ordering x86 doesn't give for free, it's a real fence on every CPU.
+
+*/
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define thread_local_storage __declspec(thread)
+#define complete_previous_writes_before_future_writes _WriteBarrier()
+#define complete_previous_reads_before_future_reads _ReadBarrier()
+#define complete_previous_writes_before_future_reads _mm_mfence()
+#define GAME_EXPORT __declspec(dllexport)
+
+// NOTE(Nader): Both return the value from before the operation.
+internal u32
+atomic_add_u32(u32 volatile *value, u32 addend)
+{
+    u32 result = (u32)_InterlockedExchangeAdd((long volatile *)value, (long)addend);
+    return(result);
+}
+
+internal u32
+atomic_compare_exchange_u32(u32 volatile *value, u32 new_value, u32 expected)
+{
+    u32 result = (u32)_InterlockedCompareExchange((long volatile *)value, (long)new_value, (long)expected);
+    return(result);
+}
+
+// NOTE(Nader): Reads the thread id out of the TEB, same value as GetCurrentThreadId.
+internal u64
+get_thread_id(void)
+{
+    u64 result = (u64)__readgsdword(0x48);
+    return(result);
+}
+#else
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#elif defined(__aarch64__)
+/*
+
+NOTE(Nader): No x86intrin here, so these stand in for the two intrinsics the rest of the
+code uses. The virtual counter ticks at a fixed rate (cntfrq_el0, usually well below the
+core clock) instead of per cycle, which is all the profiler needs since it only ever
+compares clocks against each other.
+
+*/
+internal u64
+__rdtsc(void)
+{
+    u64 result;
+    __asm__ volatile("isb; mrs %0, cntvct_el0" : "=r"(result) :: "memory");
+    return(result);
+}
+
+internal void
+_mm_pause(void)
+{
+    __asm__ volatile("yield" ::: "memory");
+}
+#else
+#error "Need __rdtsc, _mm_pause and get_thread_id for this architecture"
+#endif
+#define thread_local_storage __thread
+#define GAME_EXPORT __attribute__((visibility("default")))
+#define complete_previous_writes_before_future_writes __atomic_thread_fence(__ATOMIC_RELEASE)
+#define complete_previous_reads_before_future_reads __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define complete_previous_writes_before_future_reads __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+internal u32
+atomic_add_u32(u32 volatile *value, u32 addend)
+{
+    u32 result = __sync_fetch_and_add(value, addend);
+    return(result);
+}
+
+internal u32
+atomic_compare_exchange_u32(u32 volatile *value, u32 new_value, u32 expected)
+{
+    u32 result = __sync_val_compare_and_swap(value, expected, new_value);
+    return(result);
+}
+
+// NOTE(Nader): The thread pointer (fs:0 on x86-64, tpidr_el0 on ARM64) is unique per live thread.
+internal u64
+get_thread_id(void)
+{
+    u64 result;
+#if defined(__aarch64__)
+    __asm__ volatile("mrs %0, tpidr_el0" : "=r"(result));
+#elif defined(__x86_64__)
+    __asm__ volatile("mov %%fs:0, %0" : "=r"(result));
+#else
+    result = (u64)(uintptr_t)__builtin_thread_pointer();
+#endif
+    return(result);
+}
+#endif
@@ -0,0 +1,531 @@
+#pragma once
+
+/*
+
+NOTE(Nader): Hot path profiler, usable from the game and the platform layer.
+
+    TIMED_BLOCK(sort_render_entries)
+    {
+        ...
+    }
+
+or BEGIN_TIMED_BLOCK(name) / END_TIMED_BLOCK(name) around code that doesn't fit in one
+scope. C has no destructors, so TIMED_BLOCK is a for loop that runs once; don't return
+or break out of one or its end never gets recorded.
+
+Each thread writes begin/end events stamped with __rdtsc into its own ring buffer. Only
+the owning thread writes a ring and only the thread calling profiler_end_frame reads it,
+so recording an event is a couple of stores and a barrier, no locks. If a ring fills up
+before it is drained, new events are dropped and counted.
+
+Once per frame the platform calls profiler_end_frame, which drains every ring, pairs
+begins with ends and adds the cycles and hits of each block to that frame. We keep the
+last PROFILER_FRAME_COUNT frames, running totals per block, and the most recent
+PROFILER_MAX_TRACE_EVENTS finished blocks, which profiler_write_chrome_trace writes out
+as Chrome trace JSON (open it in chrome://tracing or ui.perfetto.dev).
+
+The Profiler itself is allocated by the platform and handed to the game through
+GameMemory. The TIMED_BLOCK macros compile away unless BLOWBACK_INTERNAL.
+
+The game code is a separate module that gets reloaded, with its own copy of the globals
+and statics in here. So threads are matched to their ring by OS thread id, and a block
+site that was already registered before a reload gets its old slot back.
+
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#define PROFILER_MAX_THREADS 16
+#define PROFILER_MAX_BLOCKS 128
+// NOTE(Nader): Must be a power of two.
+#define PROFILER_THREAD_EVENT_COUNT (1 << 16)
+#define PROFILER_MAX_OPEN_BLOCKS 64
+#define PROFILER_FRAME_COUNT 64
+#define PROFILER_MAX_TRACE_EVENTS (1 << 20)
+
+// NOTE(Nader): One per TIMED_BLOCK in the source, block_index is assigned on first use.
+typedef struct ProfilerBlockSite
+{
+    char *name;
+    char *file;
+    u32 line;
+    u32 volatile block_index_plus_one;
+} ProfilerBlockSite;
+
+typedef enum ProfilerEventType
+{
+    ProfilerEvent_BeginBlock,
+    ProfilerEvent_EndBlock,
+} ProfilerEventType;
+
+typedef struct ProfilerEvent
+{
+    u64 clock;
+    u32 block_index;
+    u32 type;
+} ProfilerEvent;
+
+typedef struct ProfilerOpenBlock
+{
+    u32 block_index;
+    u64 begin_clock;
+} ProfilerOpenBlock;
+
+typedef struct ProfilerThread
+{
+    u64 os_thread_id;
+
+    // NOTE(Nader): Written by the owning thread.
+    u32 volatile write_count;
+    u32 dropped_event_count;
+
+    // NOTE(Nader): Written by the thread calling profiler_end_frame.
+    u32 volatile read_count;
+    u32 open_block_count;
+    ProfilerOpenBlock open_blocks[PROFILER_MAX_OPEN_BLOCKS];
+
+    ProfilerEvent events[PROFILER_THREAD_EVENT_COUNT];
+} ProfilerThread;
+
+// NOTE(Nader): Names are copied in so they outlive the code that registered them.
+typedef struct ProfilerBlockInfo
+{
+    char name[32];
+    char file[32];
+    u32 line;
+
+    u64 total_cycle_count;
+    u64 total_hit_count;
+} ProfilerBlockInfo;
+
+typedef struct ProfilerBlockStats
+{
+    u64 cycle_count;
+    u32 hit_count;
+} ProfilerBlockStats;
+
+typedef struct ProfilerFrame
+{
+    u64 begin_clock;
+    u64 end_clock;
+    f64 seconds;
+    ProfilerBlockStats blocks[PROFILER_MAX_BLOCKS];
+} ProfilerFrame;
+
+typedef struct ProfilerTraceEvent
+{
+    u64 begin_clock;
+    u64 cycle_count;
+    u32 block_index;
+    u32 thread_index;
+} ProfilerTraceEvent;
+
+// NOTE(Nader): block_index of the trace events that mark whole frames.
+#define PROFILER_FRAME_BLOCK_INDEX 0xFFFFFFFF
+
+typedef struct Profiler
+{
+    u32 volatile thread_count;
+    u32 volatile block_count;
+    ProfilerBlockInfo blocks[PROFILER_MAX_BLOCKS];
+
+    u64 frame_count;
+    u64 frame_begin_clock;
+    u64 total_frame_cycle_count;
+    f64 total_frame_seconds;
+    ProfilerFrame frames[PROFILER_FRAME_COUNT];
+
+    u64 trace_event_count;
+    ProfilerTraceEvent trace_events[PROFILER_MAX_TRACE_EVENTS];
+
+    ProfilerThread threads[PROFILER_MAX_THREADS];
+} Profiler;
+
+typedef void profiler_write_function(void *context, char *text, u32 length);
+
+global Profiler *global_profiler;
+global thread_local_storage ProfilerThread *profiler_thread;
+
+#if BLOWBACK_INTERNAL
+
+#define PROFILER_CONCAT__(a, b) a##b
+#define PROFILER_CONCAT_(a, b) PROFILER_CONCAT__(a, b)
+#define PROFILER_LINE_NAME(name) PROFILER_CONCAT_(name, __LINE__)
+
+#define TIMED_BLOCK(name) \
+    local_persist ProfilerBlockSite PROFILER_LINE_NAME(profiler_site_##name##_) = {#name, __FILE__, __LINE__}; \
+    for (b32 PROFILER_LINE_NAME(timed_block_) = profiler_begin_block(&PROFILER_LINE_NAME(profiler_site_##name##_)); \
+         PROFILER_LINE_NAME(timed_block_); \
+         PROFILER_LINE_NAME(timed_block_) = profiler_end_block(&PROFILER_LINE_NAME(profiler_site_##name##_)))
+
+#define BEGIN_TIMED_BLOCK(name) \
+    local_persist ProfilerBlockSite profiler_site_##name = {#name, __FILE__, __LINE__}; \
+    profiler_begin_block(&profiler_site_##name)
+#define END_TIMED_BLOCK(name) profiler_end_block(&profiler_site_##name)
+
+#else
+
+#define TIMED_BLOCK(name)
+#define BEGIN_TIMED_BLOCK(name)
+#define END_TIMED_BLOCK(name)
+
+#endif
+
+internal void
+profiler_copy_string(char *dest, u32 dest_size, char *source)
+{
+    u32 length = 0;
+    for (; source[length] && (length < (dest_size - 1)); ++length)
+    {
+        dest[length] = source[length];
+    }
+    dest[length] = 0;
+}
+
+internal u32
+profiler_register_block(Profiler *profiler, ProfilerBlockSite *site)
+{
+    char file_name[sizeof(profiler->blocks[0].file)];
+    char *base_name = site->file;
+    for (char *at = site->file; *at; ++at)
+    {
+        if ((*at == '/') || (*at == '\\'))
+        {
+            base_name = at + 1;
+        }
+    }
+    profiler_copy_string(file_name, sizeof(file_name), base_name);
+
+    u32 block_count = profiler->block_count;
+    for (u32 block_index = 0; (block_index < block_count) && (block_index < PROFILER_MAX_BLOCKS); ++block_index)
+    {
+        ProfilerBlockInfo *info = &profiler->blocks[block_index];
+        if ((info->line == site->line) && (strcmp(info->file, file_name) == 0) &&
+            (strncmp(info->name, site->name, sizeof(info->name) - 1) == 0))
+        {
+            atomic_compare_exchange_u32(&site->block_index_plus_one, block_index + 1, 0);
+            return(site->block_index_plus_one);
+        }
+    }
+
+    u32 block_index = atomic_add_u32(&profiler->block_count, 1);
+    if (block_index < PROFILER_MAX_BLOCKS)
+    {
+        ProfilerBlockInfo *info = &profiler->blocks[block_index];
+        profiler_copy_string(info->name, sizeof(info->name), site->name);
+        profiler_copy_string(info->file, sizeof(info->file), file_name);
+        info->line = site->line;
+
+        // NOTE(Nader): Two threads can race to register the same site, the loser's slot goes unused.
+        atomic_compare_exchange_u32(&site->block_index_plus_one, block_index + 1, 0);
+    }
+    else
+    {
+        profiler->block_count = PROFILER_MAX_BLOCKS;
+        asserts(!"Too many profiler blocks");
+    }
+    return(site->block_index_plus_one);
+}
+
+internal ProfilerThread *
+profiler_register_thread(Profiler *profiler)
+{
+    u64 os_thread_id = get_thread_id();
+    u32 thread_count = profiler->thread_count;
+    for (u32 thread_index = 0; (thread_index < thread_count) && (thread_index < PROFILER_MAX_THREADS); ++thread_index)
+    {
+        if (profiler->threads[thread_index].os_thread_id == os_thread_id)
+        {
+            return(&profiler->threads[thread_index]);
+        }
+    }
+
+    ProfilerThread *result = 0;
+    u32 thread_index = atomic_add_u32(&profiler->thread_count, 1);
+    if (thread_index < PROFILER_MAX_THREADS)
+    {
+        result = &profiler->threads[thread_index];
+        result->os_thread_id = os_thread_id;
+    }
+    else
+    {
+        profiler->thread_count = PROFILER_MAX_THREADS;
+    }
+    return(result);
+}
+
+internal void
+profiler_record_event(ProfilerBlockSite *site, ProfilerEventType type)
+{
+    Profiler *profiler = global_profiler;
+    if (profiler)
+    {
+        u32 block_index_plus_one = site->block_index_plus_one;
+        if (!block_index_plus_one)
+        {
+            block_index_plus_one = profiler_register_block(profiler, site);
+        }
+
+        ProfilerThread *thread = profiler_thread;
+        if (!thread)
+        {
+            thread = profiler_thread = profiler_register_thread(profiler);
+        }
+
+        if (thread && block_index_plus_one)
+        {
+            u32 write_count = thread->write_count;
+            if ((write_count - thread->read_count) < PROFILER_THREAD_EVENT_COUNT)
+            {
+                ProfilerEvent *event = &thread->events[write_count & (PROFILER_THREAD_EVENT_COUNT - 1)];
+                event->clock = __rdtsc();
+                event->block_index = block_index_plus_one - 1;
+                event->type = type;
+
+                complete_previous_writes_before_future_writes;
+                thread->write_count = write_count + 1;
+            }
+            else
+            {
+                ++thread->dropped_event_count;
+            }
+        }
+    }
+}
+
+internal b32
+profiler_begin_block(ProfilerBlockSite *site)
+{
+    profiler_record_event(site, ProfilerEvent_BeginBlock);
+    return(true);
+}
+
+internal b32
+profiler_end_block(ProfilerBlockSite *site)
+{
+    profiler_record_event(site, ProfilerEvent_EndBlock);
+    return(false);
+}
+
+internal void
+profiler_init(Profiler *profiler)
+{
+    profiler->frame_begin_clock = __rdtsc();
+}
+
+internal void
+profiler_push_trace_event(Profiler *profiler, u64 begin_clock, u64 cycle_count,
+                          u32 block_index, u32 thread_index)
+{
+    ProfilerTraceEvent *trace_event =
+        &profiler->trace_events[profiler->trace_event_count++ % PROFILER_MAX_TRACE_EVENTS];
+    trace_event->begin_clock = begin_clock;
+    trace_event->cycle_count = cycle_count;
+    trace_event->block_index = block_index;
+    trace_event->thread_index = thread_index;
+}
+
+internal void
+profiler_collate_thread(Profiler *profiler, u32 thread_index, ProfilerFrame *frame)
+{
+    ProfilerThread *thread = &profiler->threads[thread_index];
+    u32 write_count = thread->write_count;
+    complete_previous_reads_before_future_reads;
+
+    for (u32 read_count = thread->read_count; read_count != write_count; ++read_count)
+    {
+        ProfilerEvent *event = &thread->events[read_count & (PROFILER_THREAD_EVENT_COUNT - 1)];
+        if (event->type == ProfilerEvent_BeginBlock)
+        {
+            if (thread->open_block_count < PROFILER_MAX_OPEN_BLOCKS)
+            {
+                ProfilerOpenBlock *open_block = &thread->open_blocks[thread->open_block_count++];
+                open_block->block_index = event->block_index;
+                open_block->begin_clock = event->clock;
+            }
+        }
+        else
+        {
+            // NOTE(Nader): Usually the top of the stack, unless a begin was dropped or never ended.
+            i32 open_index = (i32)thread->open_block_count - 1;
+            while ((open_index >= 0) && (thread->open_blocks[open_index].block_index != event->block_index))
+            {
+                --open_index;
+            }
+            if (open_index >= 0)
+            {
+                ProfilerOpenBlock *open_block = &thread->open_blocks[open_index];
+                u64 cycle_count = event->clock - open_block->begin_clock;
+
+                ProfilerBlockStats *stats = &frame->blocks[event->block_index];
+                stats->cycle_count += cycle_count;
+                ++stats->hit_count;
+
+                ProfilerBlockInfo *info = &profiler->blocks[event->block_index];
+                info->total_cycle_count += cycle_count;
+                ++info->total_hit_count;
+
+                profiler_push_trace_event(profiler, open_block->begin_clock, cycle_count,
+                                          event->block_index, thread_index);
+                thread->open_block_count = (u32)open_index;
+            }
+        }
+    }
+
+    // NOTE(Nader): Done reading the events, the owning thread can reuse their slots.
+    complete_previous_writes_before_future_writes;
+    thread->read_count = write_count;
+}
+
+// NOTE(Nader): seconds_elapsed is the wall clock time since the last call, used to turn cycles into time.
+internal void
+profiler_end_frame(Profiler *profiler, f64 seconds_elapsed)
+{
+    ProfilerFrame *frame = &profiler->frames[profiler->frame_count % PROFILER_FRAME_COUNT];
+    memset(frame->blocks, 0, sizeof(frame->blocks));
+    frame->begin_clock = profiler->frame_begin_clock;
+    frame->end_clock = __rdtsc();
+    frame->seconds = seconds_elapsed;
+
+    u32 thread_count = profiler->thread_count;
+    for (u32 thread_index = 0; thread_index < thread_count; ++thread_index)
+    {
+        profiler_collate_thread(profiler, thread_index, frame);
+    }
+
+    profiler_push_trace_event(profiler, frame->begin_clock, frame->end_clock - frame->begin_clock,
+                              PROFILER_FRAME_BLOCK_INDEX, 0);
+    profiler->total_frame_cycle_count += frame->end_clock - frame->begin_clock;
+    profiler->total_frame_seconds += seconds_elapsed;
+    profiler->frame_begin_clock = frame->end_clock;
+    ++profiler->frame_count;
+}
+
+internal f64
+profiler_cycles_per_second(Profiler *profiler)
+{
+    f64 result = 1.0;
+    if (profiler->total_frame_seconds > 0.0)
+    {
+        result = (f64)profiler->total_frame_cycle_count / profiler->total_frame_seconds;
+    }
+    return(result);
+}
+
+internal u32
+profiler_dropped_event_count(Profiler *profiler)
+{
+    u32 result = 0;
+    for (u32 thread_index = 0; thread_index < profiler->thread_count; ++thread_index)
+    {
+        result += profiler->threads[thread_index].dropped_event_count;
+    }
+    return(result);
+}
+
+/*
+
+NOTE(Nader): One line per block with its average per frame over every frame so far,
+in the order the blocks were first hit.
+
+*/
+internal u32
+profiler_format_summary(Profiler *profiler, char *dest, u32 dest_size)
+{
+    u32 used = 0;
+    f64 frame_count = (f64)(profiler->frame_count ? profiler->frame_count : 1);
+    f64 frame_cycle_count = (f64)profiler->total_frame_cycle_count / frame_count;
+    f64 microseconds_per_cycle = 1000000.0 / profiler_cycles_per_second(profiler);
+    for (u32 block_index = 0; (block_index < profiler->block_count) && (used < dest_size); ++block_index)
+    {
+        ProfilerBlockInfo *info = &profiler->blocks[block_index];
+        f64 cycle_count = (f64)info->total_cycle_count / frame_count;
+        int length = snprintf(dest + used, dest_size - used,
+                              "%-24s %20s:%-4u hits/f: %8.01f | kcycles/f: %10.03f | us/f: %9.03f | %5.01f%% \n",
+                              info->name, info->file, info->line, (f64)info->total_hit_count / frame_count,
+                              cycle_count / 1000.0, cycle_count*microseconds_per_cycle,
+                              (frame_cycle_count > 0.0) ? (100.0*cycle_count / frame_cycle_count) : 0.0);
+        if (length < 0)
+        {
+            break;
+        }
+        used += (u32)length;
+    }
+    if (used >= dest_size)
+    {
+        used = dest_size - 1;
+    }
+    return(used);
+}
+
+/*
+
+NOTE(Nader): Writes the trace events we still have as complete ("X") events. Timestamps
+are in microseconds from the oldest event. Frames go on their own track.
+
+*/
+internal void
+profiler_write_chrome_trace(Profiler *profiler, profiler_write_function *write, void *context)
+{
+    char text[512];
+    int length;
+    f64 microseconds_per_cycle = 1000000.0 / profiler_cycles_per_second(profiler);
+    u32 frame_thread_id = PROFILER_MAX_THREADS;
+
+    u64 first_event = 0;
+    u64 event_count = profiler->trace_event_count;
+    if (event_count > PROFILER_MAX_TRACE_EVENTS)
+    {
+        first_event = event_count - PROFILER_MAX_TRACE_EVENTS;
+    }
+
+    u64 origin_clock = (u64)-1;
+    for (u64 event_index = first_event; event_index < event_count; ++event_index)
+    {
+        ProfilerTraceEvent *trace_event = &profiler->trace_events[event_index % PROFILER_MAX_TRACE_EVENTS];
+        if (trace_event->begin_clock < origin_clock)
+        {
+            origin_clock = trace_event->begin_clock;
+        }
+    }
+
+    length = snprintf(text, sizeof(text),
+                      "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+                      "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"frames\"}}",
+                      frame_thread_id);
+    write(context, text, (u32)length);
+    for (u32 thread_index = 0; thread_index < profiler->thread_count; ++thread_index)
+    {
+        length = snprintf(text, sizeof(text),
+                          ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s %u\"}}",
+                          thread_index, (thread_index == 0) ? "main" : "thread", thread_index);
+        write(context, text, (u32)length);
+    }
+
+    for (u64 event_index = first_event; event_index < event_count; ++event_index)
+    {
+        ProfilerTraceEvent *trace_event = &profiler->trace_events[event_index % PROFILER_MAX_TRACE_EVENTS];
+        f64 timestamp = (f64)(trace_event->begin_clock - origin_clock)*microseconds_per_cycle;
+        f64 duration = (f64)trace_event->cycle_count*microseconds_per_cycle;
+        if (trace_event->block_index == PROFILER_FRAME_BLOCK_INDEX)
+        {
+            length = snprintf(text, sizeof(text),
+                              ",\n{\"name\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.03f,\"dur\":%.03f}",
+                              frame_thread_id, timestamp, duration);
+        }
+        else
+        {
+            ProfilerBlockInfo *info = &profiler->blocks[trace_event->block_index];
+            length = snprintf(text, sizeof(text),
+                              ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.03f,\"dur\":%.03f,"
+                              "\"args\":{\"cycles\":%llu,\"source\":\"%s:%u\"}}",
+                              info->name, trace_event->thread_index, timestamp, duration,
+                              (unsigned long long)trace_event->cycle_count, info->file, info->line);
+        }
+        write(context, text, (u32)length);
+    }
+
+    length = snprintf(text, sizeof(text), "\n]}\n");
+    write(context, text, (u32)length);
+}
@@ -0,0 +1,249 @@
+/*
+
+NOTE(Nader): Game side of the renderer. These only write into the push buffer, the
+platform's backend does the actual drawing after game_render returns.
+
+*/
+
+#define push_render_element(commands, type, sort_key) \
+    (type *)push_render_element_(commands, sizeof(type), RenderEntryType_##type, sort_key)
+
+/*
+
+NOTE(Nader): Allocates the command buffer for this frame out of arena (the per-frame
+transient arena, it only has to live until the backend is done with it).
+
+*/
+#define RENDER_PUSH_BUFFER_SIZE megabytes(16)
+
+internal void
+render_commands_begin(RenderCommands *commands, MemoryArena *arena, m4 view_projection)
+{
+    commands->view_projection = view_projection;
+    commands->clear_color = v4(0.0f, 0.0f, 0.0f, 1.0f);
+
+    commands->max_entry_count = MAX_RENDER_ENTRIES;
+    commands->entry_count = 0;
+    commands->sort_entries = push_array(arena, commands->max_entry_count, RenderSortEntry);
+    commands->sort_temp = push_array(arena, commands->max_entry_count, RenderSortEntry);
+
+    commands->max_batch_count = MAX_RENDER_ENTRIES;
+    commands->batch_count = 0;
+    commands->batches = push_array(arena, commands->max_batch_count, RenderBatch);
+
+    commands->max_instance_count = MAX_RENDER_INSTANCES;
+    commands->instance_count = 0;
+    commands->instances = push_array(arena, commands->max_instance_count, RenderInstance);
+    commands->static_instance_count = 0;
+
+    commands->max_texture_upload_count = MAX_RENDER_TEXTURE_UPLOADS;
+    commands->texture_upload_count = 0;
+    commands->texture_uploads = push_array(arena, commands->max_texture_upload_count, RenderTextureUpload);
+
+    commands->max_push_buffer_size = RENDER_PUSH_BUFFER_SIZE;
+    commands->push_buffer_size = 0;
+    commands->push_buffer_base = (u8 *)push_size(arena, commands->max_push_buffer_size);
+}
+
+internal void *
+push_render_element_(RenderCommands *commands, u32 size, RenderEntryType type, u32 sort_key)
+{
+    void *result = 0;
+    u32 entry_size = render_entry_header_size + align16(size);
+    if (((commands->push_buffer_size + entry_size) <= commands->max_push_buffer_size) &&
+        (commands->entry_count < commands->max_entry_count))
+    {
+        RenderEntryHeader *header = (RenderEntryHeader *)(commands->push_buffer_base +
+                                                          commands->push_buffer_size);
+        header->type = type;
+        result = render_entry_data(header);
+
+        RenderSortEntry *sort_entry = &commands->sort_entries[commands->entry_count++];
+        sort_entry->key = sort_key;
+        sort_entry->push_buffer_offset = commands->push_buffer_size;
+
+        commands->push_buffer_size += entry_size;
+    }
+    else
+    {
+        // TODO(Nader): Logging, the push buffer is too small for this frame.
+        asserts(!"Render push buffer overflow");
+    }
+    return(result);
+}
+
+internal void
+push_clear(RenderCommands *commands, v4 color)
+{
+    commands->clear_color = color;
+}
+
+internal void
+push_sprite(RenderCommands *commands, Transform2D transform, v4 color, v4 uv_rect, u32 sort_key)
+{
+    RenderEntryQuad *entry = push_render_element(commands, RenderEntryQuad, sort_key);
+    if (entry)
+    {
+        entry->transform = transform;
+        entry->color = color;
+        entry->uv_rect = uv_rect;
+    }
+}
+
+internal void
+push_quad(RenderCommands *commands, Transform2D transform, v4 color, u32 sort_key)
+{
+    push_sprite(commands, transform, color, v4(0.0f, 0.0f, 1.0f, 1.0f), sort_key);
+}
+
+// NOTE(Nader): handle can be drawn with from the frame its last rows go out on, see RenderTextureUpload.
+internal void
+push_texture_upload(RenderCommands *commands, u32 handle, u32 width, u32 height,
+                    u32 first_row, u32 row_count, u32 *pixels)
+{
+    asserts((handle != 0) && (handle < MAX_RENDER_TEXTURES));
+    asserts((first_row + row_count) <= height);
+    if (commands->texture_upload_count < commands->max_texture_upload_count)
+    {
+        RenderTextureUpload *upload = &commands->texture_uploads[commands->texture_upload_count++];
+        upload->handle = handle;
+        upload->width = width;
+        upload->height = height;
+        upload->first_row = first_row;
+        upload->row_count = row_count;
+        upload->pixels = pixels;
+    }
+    else
+    {
+        asserts(!"Too many texture uploads this frame");
+    }
+}
+
+// NOTE(Nader): instances has to stay valid until the backend has drawn this frame, see RenderEntryStaticInstances.
+internal void
+push_static_instances(RenderCommands *commands, RenderInstance *instances, u32 instance_count,
+                      u32 id, u32 version, u32 sort_key)
+{
+    asserts(id != 0);
+    RenderEntryStaticInstances *entry = push_render_element(commands, RenderEntryStaticInstances, sort_key);
+    if (entry)
+    {
+        entry->instances = instances;
+        entry->instance_count = instance_count;
+        entry->id = id;
+        entry->version = version;
+    }
+}
+
+/*
+
+NOTE(Nader): LSD radix sort, one byte per pass. It is stable, which we need so that
+entries with the same key keep their push order. Four passes means the sorted result
+ends up back in entries.
+
+*/
+internal void
+radix_sort_render_entries(RenderSortEntry *entries, RenderSortEntry *temp, u32 count)
+{
+    RenderSortEntry *source = entries;
+    RenderSortEntry *dest = temp;
+    for (u32 byte_index = 0; byte_index < 4; ++byte_index)
+    {
+        u32 shift = 8*byte_index;
+        u32 offsets[256] = {0};
+        for (u32 entry_index = 0; entry_index < count; ++entry_index)
+        {
+            ++offsets[(source[entry_index].key >> shift) & 0xFF];
+        }
+
+        u32 total = 0;
+        for (u32 bucket_index = 0; bucket_index < array_count(offsets); ++bucket_index)
+        {
+            u32 bucket_count = offsets[bucket_index];
+            offsets[bucket_index] = total;
+            total += bucket_count;
+        }
+
+        for (u32 entry_index = 0; entry_index < count; ++entry_index)
+        {
+            u32 bucket_index = (source[entry_index].key >> shift) & 0xFF;
+            dest[offsets[bucket_index]++] = source[entry_index];
+        }
+
+        RenderSortEntry *swap = source;
+        source = dest;
+        dest = swap;
+    }
+}
+
+internal void
+render_commands_end(RenderCommands *commands)
+{
+    TIMED_BLOCK(sort_render_entries)
+    {
+        radix_sort_render_entries(commands->sort_entries, commands->sort_temp, commands->entry_count);
+    }
+
+    BEGIN_TIMED_BLOCK(build_render_batches);
+    RenderBatch *batch = 0;
+    for (u32 entry_index = 0; entry_index < commands->entry_count; ++entry_index)
+    {
+        RenderSortEntry *sort_entry = &commands->sort_entries[entry_index];
+        RenderEntryHeader *header = (RenderEntryHeader *)(commands->push_buffer_base +
+                                                          sort_entry->push_buffer_offset);
+        void *data = render_entry_data(header);
+        switch (header->type)
+        {
+        case RenderEntryType_RenderEntryQuad:
+        {
+            RenderEntryQuad *entry = (RenderEntryQuad *)data;
+            if (commands->instance_count >= commands->max_instance_count)
+            {
+                asserts(!"Too many sprite instances this frame");
+                break;
+            }
+
+            if (!batch || (batch->type != header->type) || (batch->key != sort_entry->key))
+            {
+                asserts(commands->batch_count < commands->max_batch_count);
+                batch = &commands->batches[commands->batch_count++];
+                batch->type = header->type;
+                batch->key = sort_entry->key;
+                batch->first_instance = commands->instance_count;
+                batch->instance_count = 0;
+            }
+
+            RenderInstance *instance = &commands->instances[commands->instance_count++];
+            instance->color = entry->color;
+            instance->uv_rect = entry->uv_rect;
+            instance->transform = entry->transform;
+            ++batch->instance_count;
+        } break;
+        case RenderEntryType_RenderEntryStaticInstances:
+        {
+            RenderEntryStaticInstances *entry = (RenderEntryStaticInstances *)data;
+            if (!entry->instance_count)
+            {
+                break;
+            }
+
+            // NOTE(Nader): Never merged, each one is drawn straight from its own buffer.
+            asserts(commands->batch_count < commands->max_batch_count);
+            batch = &commands->batches[commands->batch_count++];
+            batch->type = header->type;
+            batch->key = sort_entry->key;
+            batch->first_instance = 0;
+            batch->instance_count = entry->instance_count;
+            batch->static_instances = entry->instances;
+            batch->static_id = entry->id;
+            batch->static_version = entry->version;
+            commands->static_instance_count += entry->instance_count;
+        } break;
+        default:
+        {
+            asserts(!"Unknown render entry type");
+        } break;
+        }
+    }
+    END_TIMED_BLOCK(build_render_batches);
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+/*
+
+NOTE(Nader): The game does not talk to the GPU. Each frame the platform layer hands
+game_render a RenderCommands, the game points it at memory carved out of
+transient storage and pushes render entries into it, and the platform hands the
+finished commands to a backend:
+
+    - renderer_opengl.c   (Win32 host)
+    - renderer_software.c (headless Linux host, no GPU)
+
+Every entry starts with a RenderEntryHeader followed by the entry itself. Entries are
+16 byte aligned because m4 holds SSE registers.
+
+Each pushed entry also gets a RenderSortEntry (key + offset into the push buffer).
+When the game is done pushing, render_commands_end sorts them by key and walks them in order,
+turning every quad into a RenderInstance and merging runs of quads with the same key into
+a single RenderBatch. Backends only see the batches: the GL backend draws each one with a
+single instanced call, so a whole sprite layer is one draw.
+
+Geometry that rarely changes (tilemap chunks) doesn't go through the per-frame instance
+buffer at all. The game bakes it once into its own memory and pushes a
+RenderEntryStaticInstances pointing at it; that becomes a batch of its own, and the GL
+backend keeps a GPU copy that it only re-uploads when the entry's version changes.
+
+Textures are named by a handle the game picks, which is what goes in the texture bits of
+a sort key, so every batch draws from one texture. Handle 0 is no texture (plain color).
+The game hands a texture's pixels over with a RenderTextureUpload, and backends process
+all of a frame's uploads before they draw anything.
+
+*/
+
+#define MAX_RENDER_ENTRIES (1 << 16)
+#define MAX_RENDER_INSTANCES (1 << 16)
+#define MAX_RENDER_TEXTURES 1024
+#define MAX_RENDER_TEXTURE_UPLOADS 64
+
+/*
+
+NOTE(Nader): Sort keys, most significant first:
+
+    layer   (8 bits)  - layers have to draw back to front, so they dominate
+    shader  (8 bits)
+    texture (16 bits)
+
+Within equal keys the sort is stable, so push order is draw order.
+
+*/
+#define render_sort_key(layer, shader, texture) \
+    ((((u32)(layer) & 0xFF) << 24) | (((u32)(shader) & 0xFF) << 16) | ((u32)(texture) & 0xFFFF))
+#define render_sort_key_texture(key) ((key) & 0xFFFF)
+
+typedef enum RenderLayer
+{
+    RenderLayer_Background,
+    RenderLayer_World,
+    RenderLayer_Player,
+    RenderLayer_UI,
+} RenderLayer;
+
+typedef enum RenderEntryType
+{
+    RenderEntryType_RenderEntryQuad,
+    RenderEntryType_RenderEntryStaticInstances,
+} RenderEntryType;
+
+typedef struct RenderEntryHeader
+{
+    RenderEntryType type;
+} RenderEntryHeader;
+
+/*
+
+NOTE(Nader): A quad is the unit sprite quad (-1 to 1 on x and y) placed in the world by
+transform and tinted by color. uv_rect is (min u, min v, width, height) of the region of
+the texture to show on it.
+
+*/
+typedef struct RenderEntryQuad
+{
+    Transform2D transform;
+    v4 color;
+    v4 uv_rect;
+} RenderEntryQuad;
+
+typedef struct RenderSortEntry
+{
+    u32 key;
+    u32 push_buffer_offset;
+} RenderSortEntry;
+
+/*
+
+NOTE(Nader): Per sprite data streamed to the GPU each frame. Sprites live in the z = 0
+plane, so their placement is a Transform2D, six floats:
+
+    world = origin + corner.x*x_axis + corner.y*y_axis
+
+The transform goes last so it packs in after the v4s; the struct is 64 bytes, one cache
+line.
+
+*/
+typedef struct RenderInstance
+{
+    v4 color;
+    v4 uv_rect;
+    Transform2D transform;
+} RenderInstance;
+
+/*
+
+NOTE(Nader): Instances the game baked ahead of time and keeps alive across frames. id
+names the geometry for as long as it exists (never 0) and version has to change every
+time the game re-bakes it, backends use the pair to tell whether their copy is stale.
+
+*/
+typedef struct RenderEntryStaticInstances
+{
+    RenderInstance *instances;
+    u32 instance_count;
+    u32 id;
+    u32 version;
+} RenderEntryStaticInstances;
+
+/*
+
+NOTE(Nader): pixels are the whole texture, 0xAARRGGBB with alpha premultiplied, width*height
+of them with row 0 at the bottom (v = 0). An upload only sends rows first_row through
+first_row + row_count - 1 of it, so a big texture can go over several frames: the one
+with first_row 0 (re)creates the texture, the rest fill it in, in order. The software
+backend samples pixels in place, so they have to stay valid for as long as the handle
+is drawn with.
+
+*/
+typedef struct RenderTextureUpload
+{
+    u32 handle;
+    u32 width;
+    u32 height;
+    u32 first_row;
+    u32 row_count;
+    u32 *pixels;
+} RenderTextureUpload;
+
+typedef struct RenderBatch
+{
+    RenderEntryType type;
+    u32 key;
+    u32 first_instance;
+    u32 instance_count;
+
+    // NOTE(Nader): Static batches only. Their instances are static_instances, not commands->instances.
+    RenderInstance *static_instances;
+    u32 static_id;
+    u32 static_version;
+} RenderBatch;
+
+typedef struct RenderCommands
+{
+    // NOTE(Nader): Filled in by the platform layer.
+    u32 width;
+    u32 height;
+
+    // NOTE(Nader): Filled in by the game. Projection times view, world space straight to clip space.
+    m4 view_projection;
+    v4 clear_color;
+
+    u32 max_push_buffer_size;
+    u32 push_buffer_size;
+    u8 *push_buffer_base;
+
+    u32 max_entry_count;
+    u32 entry_count;
+    RenderSortEntry *sort_entries;
+    RenderSortEntry *sort_temp;
+
+    u32 max_instance_count;
+    u32 instance_count;
+    RenderInstance *instances;
+
+    u32 max_batch_count;
+    u32 batch_count;
+    RenderBatch *batches;
+
+    u32 max_texture_upload_count;
+    u32 texture_upload_count;
+    RenderTextureUpload *texture_uploads;
+
+    // NOTE(Nader): Instances drawn from static batches this frame, they aren't in instance_count.
+    u32 static_instance_count;
+} RenderCommands;
+
+#define render_entry_header_size align16(sizeof(RenderEntryHeader))
+#define render_entry_data(header) ((void *)((u8 *)(header) + render_entry_header_size))
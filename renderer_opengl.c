@@ -0,0 +1,284 @@
+/*
+
+NOTE(Nader): OpenGL backend. Owns the sprite shader, the static unit quad and the
+streamed instance buffer, and plays back the batches the game built this frame.
+
+All of the frame's RenderInstances are uploaded with one orphan + sub data, then each
+batch is one glDrawElementsInstanced. GL 3.3 has no base instance, so each batch points
+the per-instance attributes at its own slice of the instance buffer instead.
+
+Static batches get a GL_STATIC_DRAW buffer each, kept across frames by id and uploaded
+again only when their version changes. When every buffer is taken the one that went
+longest without being drawn is reused.
+
+Every batch samples a texture: the one its sort key names, or a 1x1 white texture for
+handle 0 so plain color quads go through the same shader. Textures are premultiplied,
+so blending is ONE, ONE_MINUS_SRC_ALPHA.
+
+Every gl* call here goes through gl_state_cache.h, so setting the same state every frame
+or every batch costs nothing, and what's left is counted per frame.
+
+*/
+
+#define OPENGL_MAX_STATIC_BUFFERS 256
+
+typedef struct OpenGLStaticBuffer
+{
+	u32 id;
+	u32 version;
+	u32 vbo;
+	u32 last_used_frame;
+} OpenGLStaticBuffer;
+
+typedef struct OpenGL
+{
+	ShaderProgram sprite_program;
+	u32 vao;
+	u32 quad_vbo;
+	u32 quad_ebo;
+	u32 instance_vbo;
+
+	// NOTE(Nader): GL names by texture handle, 0 where nothing was uploaded. [0] is the white texture.
+	u32 textures[MAX_RENDER_TEXTURES];
+
+	u32 frame_index;
+	u32 static_buffer_count;
+	OpenGLStaticBuffer static_buffers[OPENGL_MAX_STATIC_BUFFERS];
+} OpenGL;
+
+typedef struct OpenGLInstanceAttribute
+{
+	ShaderAttributeId id;
+	u32 component_count;
+	u32 offset;
+} OpenGLInstanceAttribute;
+
+// NOTE(Nader): The transform goes up as it is, x_axis and y_axis side by side in aAxes.
+global OpenGLInstanceAttribute opengl_instance_attributes[] =
+{
+	{ShaderAttribute_aColor, 4, offsetof(RenderInstance, color)},
+	{ShaderAttribute_aUVRect, 4, offsetof(RenderInstance, uv_rect)},
+	{ShaderAttribute_aAxes, 4, offsetof(RenderInstance, transform.x_axis)},
+	{ShaderAttribute_aOrigin, 2, offsetof(RenderInstance, transform.origin)},
+};
+
+internal void
+opengl_point_instance_attributes(OpenGL *opengl, u32 first_instance)
+{
+	ShaderProgram *program = &opengl->sprite_program;
+	for (u32 attribute_index = 0; attribute_index < array_count(opengl_instance_attributes); ++attribute_index)
+	{
+		OpenGLInstanceAttribute *attribute = &opengl_instance_attributes[attribute_index];
+		i32 location = program->attribute_locations[attribute->id];
+		if (location >= 0)
+		{
+			u64 offset = first_instance*sizeof(RenderInstance) + attribute->offset;
+			glVertexAttribPointer(location, attribute->component_count, GL_FLOAT, GL_FALSE, sizeof(RenderInstance),
+								  (void *)offset);
+		}
+	}
+}
+
+// NOTE(Nader): Binds the batch's static buffer to GL_ARRAY_BUFFER, uploading it first if it's new or stale.
+internal void
+opengl_bind_static_buffer(OpenGL *opengl, RenderBatch *batch)
+{
+	OpenGLStaticBuffer *buffer = 0;
+	for (u32 buffer_index = 0; buffer_index < opengl->static_buffer_count; ++buffer_index)
+	{
+		if (opengl->static_buffers[buffer_index].id == batch->static_id)
+		{
+			buffer = &opengl->static_buffers[buffer_index];
+			break;
+		}
+	}
+
+	b32 needs_upload = !buffer || (buffer->version != batch->static_version);
+	if (!buffer)
+	{
+		if (opengl->static_buffer_count < array_count(opengl->static_buffers))
+		{
+			buffer = &opengl->static_buffers[opengl->static_buffer_count++];
+			glGenBuffers(1, &buffer->vbo);
+		}
+		else
+		{
+			buffer = &opengl->static_buffers[0];
+			for (u32 buffer_index = 1; buffer_index < opengl->static_buffer_count; ++buffer_index)
+			{
+				if (opengl->static_buffers[buffer_index].last_used_frame < buffer->last_used_frame)
+				{
+					buffer = &opengl->static_buffers[buffer_index];
+				}
+			}
+		}
+		buffer->id = batch->static_id;
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, buffer->vbo);
+	if (needs_upload)
+	{
+		glBufferData(GL_ARRAY_BUFFER, batch->instance_count*sizeof(RenderInstance), batch->static_instances,
+					 GL_STATIC_DRAW);
+		buffer->version = batch->static_version;
+	}
+	buffer->last_used_frame = opengl->frame_index;
+}
+
+// NOTE(Nader): Rows first_row to first_row + row_count - 1 of pixels, see RenderTextureUpload.
+internal void
+opengl_upload_texture(OpenGL *opengl, u32 handle, u32 width, u32 height, u32 first_row, u32 row_count, u32 *pixels)
+{
+	if (!opengl->textures[handle])
+	{
+		glGenTextures(1, &opengl->textures[handle]);
+	}
+	glBindTexture(GL_TEXTURE_2D, opengl->textures[handle]);
+	if (first_row == 0)
+	{
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_BGRA, GL_UNSIGNED_BYTE, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, first_row, width, row_count, GL_BGRA, GL_UNSIGNED_BYTE,
+					pixels + first_row*width);
+}
+
+internal void
+opengl_bind_batch_texture(OpenGL *opengl, RenderBatch *batch)
+{
+	u32 handle = render_sort_key_texture(batch->key);
+	u32 texture = opengl->textures[0];
+	if ((handle < MAX_RENDER_TEXTURES) && opengl->textures[handle])
+	{
+		texture = opengl->textures[handle];
+	}
+	glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+internal void
+opengl_init(OpenGL *opengl, char *vertex_shader_source, char *fragment_shader_source)
+{
+	gl_state_cache_reset();
+	opengl->sprite_program = create_shader_program(vertex_shader_source, fragment_shader_source);
+	ShaderProgram *program = &opengl->sprite_program;
+
+	f32 vertices[] = {
+		// position          // uv
+		1.0f, 1.0f, 0.0f,    1.0f, 1.0f,   // top right
+		1.0f, -1.0f, 0.0f,   1.0f, 0.0f,   // bottom right
+		-1.0f, -1.0f, 0.0f,  0.0f, 0.0f,   // bottom left
+		-1.0f, 1.0f, 0.0f,   0.0f, 1.0f,   // top left
+	};
+
+	u32 indices[] = {
+		0, 1, 3,    // first triangle
+		1, 2, 3     // second triangle
+	};
+
+	glGenVertexArrays(1, &opengl->vao);
+	glGenBuffers(1, &opengl->quad_vbo);
+	glGenBuffers(1, &opengl->quad_ebo);
+	glGenBuffers(1, &opengl->instance_vbo);
+
+	glBindVertexArray(opengl->vao);
+
+	glBindBuffer(GL_ARRAY_BUFFER, opengl->quad_vbo);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, opengl->quad_ebo);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+	i32 position_location = program->attribute_locations[ShaderAttribute_aPos];
+	i32 uv_location = program->attribute_locations[ShaderAttribute_aUV];
+	glVertexAttribPointer(position_location, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+	glEnableVertexAttribArray(position_location);
+	if (uv_location >= 0)
+	{
+		glVertexAttribPointer(uv_location, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+		glEnableVertexAttribArray(uv_location);
+	}
+
+	glBindBuffer(GL_ARRAY_BUFFER, opengl->instance_vbo);
+	glBufferData(GL_ARRAY_BUFFER, MAX_RENDER_INSTANCES*sizeof(RenderInstance), 0, GL_STREAM_DRAW);
+	for (u32 attribute_index = 0; attribute_index < array_count(opengl_instance_attributes); ++attribute_index)
+	{
+		i32 location = program->attribute_locations[opengl_instance_attributes[attribute_index].id];
+		if (location >= 0)
+		{
+			glEnableVertexAttribArray(location);
+			glVertexAttribDivisor(location, 1);
+		}
+	}
+	opengl_point_instance_attributes(opengl, 0);
+
+	u32 white = 0xFFFFFFFF;
+	opengl_upload_texture(opengl, 0, 1, 1, 0, 1, &white);
+	glActiveTexture(GL_TEXTURE0);
+}
+
+internal void
+opengl_render_commands(OpenGL *opengl, RenderCommands *commands)
+{
+	BEGIN_TIMED_BLOCK(opengl_render_commands);
+	glViewport(0, 0, commands->width, commands->height);
+	glClearColor(commands->clear_color.R, commands->clear_color.G,
+				 commands->clear_color.B, commands->clear_color.A);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	for (u32 upload_index = 0; upload_index < commands->texture_upload_count; ++upload_index)
+	{
+		RenderTextureUpload *upload = &commands->texture_uploads[upload_index];
+		opengl_upload_texture(opengl, upload->handle, upload->width, upload->height,
+							  upload->first_row, upload->row_count, upload->pixels);
+	}
+
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+	ShaderProgram *program = &opengl->sprite_program;
+	glUseProgram(program->handle);
+	glBindVertexArray(opengl->vao);
+
+	shader_set_m4(program, ShaderUniform_view_projection, &commands->view_projection);
+
+	++opengl->frame_index;
+	glBindBuffer(GL_ARRAY_BUFFER, opengl->instance_vbo);
+	if (commands->instance_count)
+	{
+		// NOTE(Nader): Orphan last frame's storage so we don't stall on the GPU still reading it.
+		glBufferData(GL_ARRAY_BUFFER, MAX_RENDER_INSTANCES*sizeof(RenderInstance), 0, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, commands->instance_count*sizeof(RenderInstance),
+						commands->instances);
+	}
+
+	for (u32 batch_index = 0; batch_index < commands->batch_count; ++batch_index)
+	{
+		RenderBatch *batch = &commands->batches[batch_index];
+		opengl_bind_batch_texture(opengl, batch);
+		switch (batch->type)
+		{
+		case RenderEntryType_RenderEntryQuad:
+		{
+			// NOTE(Nader): The per-instance attribute pointers source from whatever is bound here.
+			glBindBuffer(GL_ARRAY_BUFFER, opengl->instance_vbo);
+			opengl_point_instance_attributes(opengl, batch->first_instance);
+			glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, batch->instance_count);
+		} break;
+		case RenderEntryType_RenderEntryStaticInstances:
+		{
+			opengl_bind_static_buffer(opengl, batch);
+			opengl_point_instance_attributes(opengl, 0);
+			glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, batch->instance_count);
+		} break;
+		default:
+		{
+			asserts(!"Unknown render batch type");
+		} break;
+		}
+	}
+	gl_state_cache_end_frame();
+	END_TIMED_BLOCK(opengl_render_commands);
+}
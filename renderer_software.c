@@ -0,0 +1,349 @@
+/*
+
+NOTE(Nader): CPU rasterizer backend. Draws RenderCommands into a 32-bit framebuffer in
+memory so we can render on machines without a GPU (golden images, throughput runs).
+
+Pixels are 0xAARRGGBB and row 0 is the bottom of the screen, same as the GL default
+framebuffer. Quads are rasterized as convex polygons, a pixel is covered when its
+center is inside all four edges. Spans are filled 4 pixels at a time with SSE2.
+
+Textured quads sample their texture with nearest filtering and blend over what's there
+(premultiplied alpha, same as the GL backend). Quads with texture 0 are a plain fill.
+Textures are the game's pixels, uploading one only keeps a pointer to them.
+
+*/
+
+#if defined(__SSE2__) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SOFTWARE_RENDERER_USE_SSE2 1
+#endif
+
+typedef struct SoftwareFramebuffer
+{
+    u32 width;
+    u32 height;
+    // NOTE(Nader): pitch is in pixels, not bytes.
+    u32 pitch;
+    u32 *pixels;
+} SoftwareFramebuffer;
+
+typedef struct SoftwareTexture
+{
+    u32 width;
+    u32 height;
+    u32 *pixels;
+} SoftwareTexture;
+
+typedef struct SoftwareRenderer
+{
+    SoftwareFramebuffer framebuffer;
+    SoftwareTexture textures[MAX_RENDER_TEXTURES];
+} SoftwareRenderer;
+
+/*
+
+NOTE(Nader): How a textured quad maps the screen to its texture. A pixel center p is at
+origin + s*x_edge + t*y_edge, s and t going 0 to 1 across the quad, and inverse_row_0/1
+are the rows of the inverse of [x_edge y_edge] that give s and t back. color is the tint,
+premultiplied.
+
+*/
+typedef struct SoftwareTextureMapping
+{
+    SoftwareTexture *texture;
+    v2 origin;
+    v2 inverse_row_0;
+    v2 inverse_row_1;
+    v4 uv_rect;
+    v4 color;
+} SoftwareTextureMapping;
+
+internal u32
+software_pack_color(v4 color)
+{
+    f32 r = HMM_Clamp(0.0f, color.R, 1.0f);
+    f32 g = HMM_Clamp(0.0f, color.G, 1.0f);
+    f32 b = HMM_Clamp(0.0f, color.B, 1.0f);
+    f32 a = HMM_Clamp(0.0f, color.A, 1.0f);
+    u32 result = (((u32)(a*255.0f + 0.5f) << 24) |
+                  ((u32)(r*255.0f + 0.5f) << 16) |
+                  ((u32)(g*255.0f + 0.5f) << 8) |
+                  ((u32)(b*255.0f + 0.5f) << 0));
+    return(result);
+}
+
+internal void
+software_fill_span(u32 *row, i32 min_x, i32 one_past_max_x, u32 color)
+{
+    i32 x = min_x;
+#if SOFTWARE_RENDERER_USE_SSE2
+    __m128i wide_color = _mm_set1_epi32((int)color);
+    for (; x + 4 <= one_past_max_x; x += 4)
+    {
+        _mm_storeu_si128((__m128i *)(row + x), wide_color);
+    }
+#endif
+    for (; x < one_past_max_x; ++x)
+    {
+        row[x] = color;
+    }
+}
+
+internal void
+software_fill_textured_span(u32 *row, i32 y, i32 min_x, i32 one_past_max_x, SoftwareTextureMapping *mapping)
+{
+    SoftwareTexture *texture = mapping->texture;
+    f32 texture_width = (f32)texture->width;
+    f32 texture_height = (f32)texture->height;
+    f32 d_y = ((f32)y + 0.5f) - mapping->origin.Y;
+    for (i32 x = min_x; x < one_past_max_x; ++x)
+    {
+        f32 d_x = ((f32)x + 0.5f) - mapping->origin.X;
+        f32 s = mapping->inverse_row_0.X*d_x + mapping->inverse_row_0.Y*d_y;
+        f32 t = mapping->inverse_row_1.X*d_x + mapping->inverse_row_1.Y*d_y;
+        f32 u = mapping->uv_rect.X + s*mapping->uv_rect.Z;
+        f32 v = mapping->uv_rect.Y + t*mapping->uv_rect.W;
+
+        i32 texel_x = HMM_MIN(HMM_MAX((i32)floorf(u*texture_width), 0), (i32)texture->width - 1);
+        i32 texel_y = HMM_MIN(HMM_MAX((i32)floorf(v*texture_height), 0), (i32)texture->height - 1);
+        u32 texel = texture->pixels[texel_y*texture->width + texel_x];
+
+        f32 inv_255 = 1.0f / 255.0f;
+        f32 source_a = mapping->color.A*inv_255*(f32)((texel >> 24) & 0xFF);
+        f32 source_r = mapping->color.R*inv_255*(f32)((texel >> 16) & 0xFF);
+        f32 source_g = mapping->color.G*inv_255*(f32)((texel >> 8) & 0xFF);
+        f32 source_b = mapping->color.B*inv_255*(f32)((texel >> 0) & 0xFF);
+
+        u32 dest = row[x];
+        f32 inv_source_a = 1.0f - source_a;
+        v4 blended;
+        blended.R = source_r + inv_source_a*inv_255*(f32)((dest >> 16) & 0xFF);
+        blended.G = source_g + inv_source_a*inv_255*(f32)((dest >> 8) & 0xFF);
+        blended.B = source_b + inv_source_a*inv_255*(f32)((dest >> 0) & 0xFF);
+        blended.A = source_a + inv_source_a*inv_255*(f32)((dest >> 24) & 0xFF);
+        row[x] = software_pack_color(blended);
+    }
+}
+
+internal void
+software_clear(SoftwareFramebuffer *framebuffer, v4 color)
+{
+    u32 packed = software_pack_color(color);
+    for (u32 y = 0; y < framebuffer->height; ++y)
+    {
+        software_fill_span(framebuffer->pixels + y*framebuffer->pitch, 0, (i32)framebuffer->width, packed);
+    }
+}
+
+/*
+
+NOTE(Nader): Each edge is a line a*x + b*y + c >= 0 on the inside. For a given row we
+solve every edge for the range of x that is inside, and the intersection of those ranges
+is the span to fill. With a mapping the span is textured, otherwise it's filled with color.
+
+*/
+internal void
+software_draw_convex_polygon(SoftwareFramebuffer *framebuffer, v2 *points, u32 point_count, u32 color,
+                             SoftwareTextureMapping *mapping)
+{
+    f32 edge_a[4];
+    f32 edge_b[4];
+    f32 edge_c[4];
+
+    f32 signed_area = 0.0f;
+    f32 min_y = points[0].Y;
+    f32 max_y = points[0].Y;
+    for (u32 point_index = 0; point_index < point_count; ++point_index)
+    {
+        v2 p0 = points[point_index];
+        v2 p1 = points[(point_index + 1) % point_count];
+        signed_area += p0.X*p1.Y - p1.X*p0.Y;
+        min_y = HMM_MIN(min_y, p0.Y);
+        max_y = HMM_MAX(max_y, p0.Y);
+    }
+    if (signed_area == 0.0f)
+    {
+        return;
+    }
+
+    // NOTE(Nader): Flip the edges of clockwise polygons so inside is always >= 0.
+    f32 winding = (signed_area > 0.0f) ? 1.0f : -1.0f;
+    for (u32 point_index = 0; point_index < point_count; ++point_index)
+    {
+        v2 p0 = points[point_index];
+        v2 p1 = points[(point_index + 1) % point_count];
+        edge_a[point_index] = winding*(p0.Y - p1.Y);
+        edge_b[point_index] = winding*(p1.X - p0.X);
+        edge_c[point_index] = winding*(p0.X*p1.Y - p1.X*p0.Y);
+    }
+
+    i32 first_row = HMM_MAX((i32)ceilf(min_y - 0.5f), 0);
+    i32 one_past_last_row = HMM_MIN((i32)floorf(max_y - 0.5f) + 1, (i32)framebuffer->height);
+    for (i32 y = first_row; y < one_past_last_row; ++y)
+    {
+        f32 center_y = (f32)y + 0.5f;
+        f32 span_min = 0.0f;
+        f32 span_max = (f32)framebuffer->width;
+        for (u32 edge_index = 0; edge_index < point_count; ++edge_index)
+        {
+            f32 a = edge_a[edge_index];
+            f32 rest = edge_b[edge_index]*center_y + edge_c[edge_index];
+            if (a > 0.0f)
+            {
+                span_min = HMM_MAX(span_min, -rest / a);
+            }
+            else if (a < 0.0f)
+            {
+                span_max = HMM_MIN(span_max, -rest / a);
+            }
+            else if (rest < 0.0f)
+            {
+                span_max = span_min;
+            }
+        }
+
+        i32 min_x = (i32)ceilf(span_min - 0.5f);
+        i32 one_past_max_x = (i32)floorf(span_max - 0.5f) + 1;
+        min_x = HMM_MAX(min_x, 0);
+        one_past_max_x = HMM_MIN(one_past_max_x, (i32)framebuffer->width);
+        if (min_x < one_past_max_x)
+        {
+            u32 *row = framebuffer->pixels + y*framebuffer->pitch;
+            if (mapping)
+            {
+                software_fill_textured_span(row, y, min_x, one_past_max_x, mapping);
+            }
+            else
+            {
+                software_fill_span(row, min_x, one_past_max_x, color);
+            }
+        }
+    }
+}
+
+// NOTE(Nader): texture is 0 for a plain color quad.
+internal void
+software_draw_sprite(SoftwareFramebuffer *framebuffer, m4 view_projection, RenderInstance *instance,
+                     SoftwareTexture *texture)
+{
+    // NOTE(Nader): Same corners as the sprite vertex buffer, walked around the outline
+    // (top right, bottom right, bottom left, top left).
+    v2 origin = instance->transform.origin;
+    v2 x_axis = instance->transform.x_axis;
+    v2 y_axis = instance->transform.y_axis;
+    v2 corners[4];
+    corners[0] = HMM_AddV2(origin, HMM_AddV2(x_axis, y_axis));
+    corners[1] = HMM_AddV2(origin, HMM_SubV2(x_axis, y_axis));
+    corners[2] = HMM_SubV2(origin, HMM_AddV2(x_axis, y_axis));
+    corners[3] = HMM_SubV2(origin, HMM_SubV2(x_axis, y_axis));
+
+    v2 points[4];
+    for (u32 corner_index = 0; corner_index < array_count(points); ++corner_index)
+    {
+        v4 clip = HMM_MulM4V4(view_projection, v4(corners[corner_index].X, corners[corner_index].Y, 0.0f, 1.0f));
+        if (clip.W <= 0.0f)
+        {
+            // TODO(Nader): Clip against the near plane if we ever use a perspective projection.
+            return;
+        }
+        f32 inv_w = 1.0f / clip.W;
+        points[corner_index].X = (clip.X*inv_w*0.5f + 0.5f)*(f32)framebuffer->width;
+        points[corner_index].Y = (clip.Y*inv_w*0.5f + 0.5f)*(f32)framebuffer->height;
+    }
+
+    SoftwareTextureMapping mapping;
+    SoftwareTextureMapping *textured = 0;
+    if (texture)
+    {
+        // NOTE(Nader): Bottom left is uv (0, 0). Orthographic only, the mapping is affine
+        // across the whole quad.
+        v2 origin = points[2];
+        v2 x_edge = HMM_SubV2(points[1], origin);
+        v2 y_edge = HMM_SubV2(points[3], origin);
+        f32 determinant = x_edge.X*y_edge.Y - x_edge.Y*y_edge.X;
+        if (determinant == 0.0f)
+        {
+            return;
+        }
+        f32 inv_determinant = 1.0f / determinant;
+        mapping.texture = texture;
+        mapping.origin = origin;
+        mapping.inverse_row_0 = v2(y_edge.Y*inv_determinant, -y_edge.X*inv_determinant);
+        mapping.inverse_row_1 = v2(-x_edge.Y*inv_determinant, x_edge.X*inv_determinant);
+        mapping.uv_rect = instance->uv_rect;
+        f32 alpha = HMM_Clamp(0.0f, instance->color.A, 1.0f);
+        mapping.color = v4(alpha*instance->color.R, alpha*instance->color.G, alpha*instance->color.B, alpha);
+        textured = &mapping;
+    }
+
+    software_draw_convex_polygon(framebuffer, points, array_count(points),
+                                 software_pack_color(instance->color), textured);
+}
+
+internal void
+software_upload_textures(SoftwareRenderer *renderer, RenderCommands *commands)
+{
+    for (u32 upload_index = 0; upload_index < commands->texture_upload_count; ++upload_index)
+    {
+        RenderTextureUpload *upload = &commands->texture_uploads[upload_index];
+        SoftwareTexture *texture = &renderer->textures[upload->handle];
+        texture->width = upload->width;
+        texture->height = upload->height;
+        texture->pixels = upload->pixels;
+    }
+}
+
+internal SoftwareTexture *
+software_get_batch_texture(SoftwareRenderer *renderer, RenderBatch *batch)
+{
+    SoftwareTexture *result = 0;
+    u32 handle = render_sort_key_texture(batch->key);
+    if (handle && (handle < MAX_RENDER_TEXTURES) && renderer->textures[handle].pixels)
+    {
+        result = &renderer->textures[handle];
+    }
+    return(result);
+}
+
+internal void
+software_render_commands(SoftwareRenderer *renderer, RenderCommands *commands)
+{
+    BEGIN_TIMED_BLOCK(software_render_commands);
+    SoftwareFramebuffer *framebuffer = &renderer->framebuffer;
+    software_upload_textures(renderer, commands);
+    TIMED_BLOCK(software_clear)
+    {
+        software_clear(framebuffer, commands->clear_color);
+    }
+
+    m4 view_projection = commands->view_projection;
+    for (u32 batch_index = 0; batch_index < commands->batch_count; ++batch_index)
+    {
+        RenderBatch *batch = &commands->batches[batch_index];
+        SoftwareTexture *texture = software_get_batch_texture(renderer, batch);
+        switch (batch->type)
+        {
+        case RenderEntryType_RenderEntryQuad:
+        {
+            RenderInstance *instances = commands->instances + batch->first_instance;
+            for (u32 instance_index = 0; instance_index < batch->instance_count; ++instance_index)
+            {
+                software_draw_sprite(framebuffer, view_projection, instances + instance_index, texture);
+            }
+        } break;
+        case RenderEntryType_RenderEntryStaticInstances:
+        {
+            RenderInstance *instances = batch->static_instances;
+            for (u32 instance_index = 0; instance_index < batch->instance_count; ++instance_index)
+            {
+                software_draw_sprite(framebuffer, view_projection, instances + instance_index, texture);
+            }
+        } break;
+        default:
+        {
+            asserts(!"Unknown render batch type");
+        } break;
+        }
+    }
+    END_TIMED_BLOCK(software_render_commands);
+}
@@ -0,0 +1,258 @@
+/*
+
+NOTE(Nader): Input recording and playback, shared by the platform layers. The platform
+does the file I/O, this file only knows the format.
+
+A replay is a ReplayHeader, a snapshot of permanent storage taken when recording
+started, then one record per simulate step (see game_simulate in blowback.h), so it plays
+back the same at any frame rate:
+
+    u16 encoded_size
+    u8  encoded[encoded_size]
+
+Each step's GameInput is XORed against the previous step's, which is almost all
+zeros, and the result is run length encoded as (u16 zero_count, u16 literal_count,
+literal bytes) pairs. A step where nothing changed costs 6 bytes.
+
+The snapshot only stores permanent storage up to its last non-zero byte, the rest of
+the block is zero when we restore it. Transient storage is not saved; the game has to
+treat it as scratch that can be rebuilt from permanent storage.
+
+The snapshot is permanent storage byte for byte, pointers included (the EntityStore's
+arrays, the spatial hash's, arena bases), so it only means anything at the address it
+was taken at. The header records that address and playback refuses a replay recorded
+anywhere else. Internal builds put game memory at a fixed address (see the platform
+layers' game memory allocation), so their replays play back from run to run; other
+builds map it wherever the OS likes, and only play back replays from the same run.
+
+*/
+
+#define REPLAY_MAGIC 0x50524242 // "BBRP"
+#define REPLAY_VERSION 3
+
+typedef struct ReplayHeader
+{
+    u32 magic;
+    u32 version;
+    u32 input_size;
+    b32 memory_is_initialized;
+    u64 permanent_storage_size;
+    u64 permanent_storage_base;
+    u64 snapshot_size;
+} ReplayHeader;
+
+#define REPLAY_MAX_ENCODED_INPUT_SIZE (3*sizeof(GameInput) + 8)
+
+typedef struct ReplayPlayback
+{
+    u8 *base;
+    u64 size;
+
+    ReplayHeader *header;
+    u8 *snapshot;
+    u64 first_frame_offset;
+
+    u64 at;
+    GameInput previous_input;
+    u32 loop_count;
+} ReplayPlayback;
+
+internal u64
+replay_snapshot_size(void *memory, u64 size)
+{
+    u64 *words = (u64 *)memory;
+    u64 word_count = size / sizeof(u64);
+    while (word_count && (words[word_count - 1] == 0))
+    {
+        --word_count;
+    }
+    u64 result = word_count*sizeof(u64);
+    return(result);
+}
+
+internal void
+replay_write_u16(u8 *dest, u16 value)
+{
+    dest[0] = (u8)(value & 0xFF);
+    dest[1] = (u8)(value >> 8);
+}
+
+internal u16
+replay_read_u16(u8 *source)
+{
+    u16 result = (u16)(source[0] | (source[1] << 8));
+    return(result);
+}
+
+// NOTE(Nader): Writes the u16 size prefix and the encoded input, returns the total byte count.
+internal u32
+replay_encode_input(GameInput *input, GameInput *previous_input, u8 *dest)
+{
+    u8 *new_bytes = (u8 *)input;
+    u8 *old_bytes = (u8 *)previous_input;
+    u32 byte_count = sizeof(GameInput);
+
+    u8 *at = dest + sizeof(u16);
+    u32 index = 0;
+    while (index < byte_count)
+    {
+        u32 zero_count = 0;
+        while ((index < byte_count) && (zero_count < 0xFFFF) && (new_bytes[index] == old_bytes[index]))
+        {
+            ++zero_count;
+            ++index;
+        }
+
+        u8 *literal_count_at = at + sizeof(u16);
+        u8 *literals = literal_count_at + sizeof(u16);
+        u32 literal_count = 0;
+        while ((index < byte_count) && (literal_count < 0xFFFF) && (new_bytes[index] != old_bytes[index]))
+        {
+            literals[literal_count++] = new_bytes[index] ^ old_bytes[index];
+            ++index;
+        }
+
+        replay_write_u16(at, (u16)zero_count);
+        replay_write_u16(literal_count_at, (u16)literal_count);
+        at = literals + literal_count;
+    }
+
+    u32 encoded_size = (u32)(at - (dest + sizeof(u16)));
+    asserts(encoded_size + sizeof(u16) <= REPLAY_MAX_ENCODED_INPUT_SIZE);
+    replay_write_u16(dest, (u16)encoded_size);
+    return(encoded_size + sizeof(u16));
+}
+
+internal b32
+replay_decode_input(u8 *source, u32 source_size, GameInput *previous_input, GameInput *input)
+{
+    *input = *previous_input;
+    u8 *bytes = (u8 *)input;
+    u32 byte_count = sizeof(GameInput);
+
+    u32 index = 0;
+    u8 *at = source;
+    u8 *end = source + source_size;
+    while (at < end)
+    {
+        if ((end - at) < 4)
+        {
+            return(false);
+        }
+        u32 zero_count = replay_read_u16(at);
+        u32 literal_count = replay_read_u16(at + sizeof(u16));
+        at += 2*sizeof(u16);
+        if (((index + zero_count + literal_count) > byte_count) || ((u32)(end - at) < literal_count))
+        {
+            return(false);
+        }
+
+        index += zero_count;
+        for (u32 literal_index = 0; literal_index < literal_count; ++literal_index)
+        {
+            bytes[index++] ^= *at++;
+        }
+    }
+    return(true);
+}
+
+internal void
+replay_fill_header(ReplayHeader *header, GameMemory *memory)
+{
+    header->magic = REPLAY_MAGIC;
+    header->version = REPLAY_VERSION;
+    header->input_size = sizeof(GameInput);
+    header->memory_is_initialized = memory->is_initialized;
+    header->permanent_storage_size = memory->permanent_storage_size;
+    header->permanent_storage_base = (u64)(uintptr_t)memory->permanent_storage;
+    header->snapshot_size = replay_snapshot_size(memory->permanent_storage, memory->permanent_storage_size);
+}
+
+// NOTE(Nader): replay is the whole file in memory. Returns false if it is not a replay we can play.
+internal b32
+replay_begin_playback(ReplayPlayback *playback, void *replay, u64 replay_size, GameMemory *memory)
+{
+    b32 result = false;
+    ReplayHeader *header = (ReplayHeader *)replay;
+    if ((replay_size >= sizeof(ReplayHeader)) &&
+        (header->magic == REPLAY_MAGIC) &&
+        (header->version == REPLAY_VERSION) &&
+        (header->input_size == sizeof(GameInput)) &&
+        (header->permanent_storage_size == memory->permanent_storage_size) &&
+        (header->permanent_storage_base == (u64)(uintptr_t)memory->permanent_storage) &&
+        (header->snapshot_size <= header->permanent_storage_size) &&
+        ((sizeof(ReplayHeader) + header->snapshot_size) <= replay_size))
+    {
+        playback->base = (u8 *)replay;
+        playback->size = replay_size;
+        playback->header = header;
+        playback->snapshot = playback->base + sizeof(ReplayHeader);
+        playback->first_frame_offset = sizeof(ReplayHeader) + header->snapshot_size;
+        playback->loop_count = 0;
+        result = true;
+    }
+    return(result);
+}
+
+// NOTE(Nader): Puts game memory back the way it was when recording started.
+internal void
+replay_restore_snapshot(ReplayPlayback *playback, GameMemory *memory)
+{
+    ReplayHeader *header = playback->header;
+    u8 *permanent_storage = (u8 *)memory->permanent_storage;
+    memcpy(permanent_storage, playback->snapshot, header->snapshot_size);
+    memset(permanent_storage + header->snapshot_size, 0,
+           memory->permanent_storage_size - header->snapshot_size);
+    memory->is_initialized = header->memory_is_initialized;
+
+    playback->at = playback->first_frame_offset;
+    memset(&playback->previous_input, 0, sizeof(playback->previous_input));
+}
+
+/*
+
+NOTE(Nader): Fills input with the next recorded step. At the end of the replay it
+returns false, and the caller decides whether to restore the snapshot and loop.
+
+*/
+internal b32
+replay_playback_input(ReplayPlayback *playback, GameInput *input)
+{
+    b32 result = false;
+    if ((playback->at + sizeof(u16)) <= playback->size)
+    {
+        u8 *record = playback->base + playback->at;
+        u32 encoded_size = replay_read_u16(record);
+        if ((playback->at + sizeof(u16) + encoded_size) <= playback->size)
+        {
+            if (replay_decode_input(record + sizeof(u16), encoded_size, &playback->previous_input, input))
+            {
+                playback->previous_input = *input;
+                playback->at += sizeof(u16) + encoded_size;
+                result = true;
+            }
+        }
+    }
+    return(result);
+}
+
+// NOTE(Nader): 64-bit FNV-1a over words, so two runs of the game can be diffed cheaply.
+internal u64
+hash_memory(void *memory, u64 size)
+{
+    u64 result = 0xcbf29ce484222325ULL;
+    u64 *words = (u64 *)memory;
+    u64 word_count = size / sizeof(u64);
+    for (u64 word_index = 0; word_index < word_count; ++word_index)
+    {
+        result ^= words[word_index];
+        result *= 0x100000001b3ULL;
+    }
+    u8 *bytes = (u8 *)(words + word_count);
+    for (u64 byte_index = 0; byte_index < (size % sizeof(u64)); ++byte_index)
+    {
+        result ^= bytes[byte_index];
+        result *= 0x100000001b3ULL;
+    }
+    return(result);
+}
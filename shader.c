@@ -48,3 +48,143 @@ check_shader_errors(char *type, u32 object)
 		}
 	}
 }
+
+internal u32
+compile_shader_program(char *vertex_shader_source, char *fragment_shader_source)
+{
+	u32 vertex_shader = glCreateShader(GL_VERTEX_SHADER);
+	glShaderSource(vertex_shader, 1, &vertex_shader_source, NULL);
+	glCompileShader(vertex_shader);
+
+	u32 fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(fragment_shader, 1, &fragment_shader_source, NULL);
+	glCompileShader(fragment_shader);
+
+	check_shader_errors("VERTEX", vertex_shader);
+	check_shader_errors("FRAGMENT", fragment_shader);
+
+	u32 shader_program = glCreateProgram();
+	glAttachShader(shader_program, vertex_shader);
+	glAttachShader(shader_program, fragment_shader);
+	glLinkProgram(shader_program);
+
+	check_shader_errors("PROGRAM", shader_program);
+
+	glDeleteShader(vertex_shader);
+	glDeleteShader(fragment_shader);
+
+	return(shader_program);
+}
+
+/*
+
+NOTE(Nader): Every uniform and attribute the engine's shaders use gets an id here, and
+create_shader_program resolves all of their locations once at link time. Nothing on
+the per-frame path calls glGetUniformLocation.
+
+The setters keep a copy of the last value uploaded to each uniform (uniform values are
+stored per program, so the copy stays valid across glUseProgram) and skip the upload
+when the value has not changed. A skipped upload is counted as a filtered call in
+gl_state_cache, so it shows up next to the uploads that did happen. They assume the
+program is the one in use.
+
+*/
+typedef enum ShaderUniformId
+{
+	ShaderUniform_view_projection,
+
+	ShaderUniform_Count,
+} ShaderUniformId;
+
+global char *shader_uniform_names[ShaderUniform_Count] =
+{
+	"view_projection",
+};
+
+typedef enum ShaderAttributeId
+{
+	ShaderAttribute_aPos,
+	ShaderAttribute_aUV,
+	ShaderAttribute_aAxes,
+	ShaderAttribute_aOrigin,
+	ShaderAttribute_aColor,
+	ShaderAttribute_aUVRect,
+
+	ShaderAttribute_Count,
+} ShaderAttributeId;
+
+global char *shader_attribute_names[ShaderAttribute_Count] =
+{
+	"aPos",
+	"aUV",
+	"aAxes",
+	"aOrigin",
+	"aColor",
+	"aUVRect",
+};
+
+typedef struct ShaderUniform
+{
+	// NOTE(Nader): -1 when the program does not use this uniform, setters ignore it.
+	i32 location;
+	b32 has_value;
+	f32 value[16];
+} ShaderUniform;
+
+typedef struct ShaderProgram
+{
+	u32 handle;
+	ShaderUniform uniforms[ShaderUniform_Count];
+	i32 attribute_locations[ShaderAttribute_Count];
+} ShaderProgram;
+
+internal ShaderProgram
+create_shader_program(char *vertex_shader_source, char *fragment_shader_source)
+{
+	ShaderProgram result = { 0 };
+	result.handle = compile_shader_program(vertex_shader_source, fragment_shader_source);
+
+	for (u32 uniform_index = 0; uniform_index < ShaderUniform_Count; ++uniform_index)
+	{
+		result.uniforms[uniform_index].location =
+			glGetUniformLocation(result.handle, shader_uniform_names[uniform_index]);
+	}
+
+	for (u32 attribute_index = 0; attribute_index < ShaderAttribute_Count; ++attribute_index)
+	{
+		result.attribute_locations[attribute_index] =
+			glGetAttribLocation(result.handle, shader_attribute_names[attribute_index]);
+	}
+
+	return(result);
+}
+
+// NOTE(Nader): False when the uniform already has this value, or when the program doesn't use it.
+internal b32
+shader_uniform_changed(ShaderProgram *program, ShaderUniformId id, void *value, u32 value_size)
+{
+	b32 result = false;
+	ShaderUniform *uniform = &program->uniforms[id];
+	asserts(value_size <= sizeof(uniform->value));
+	if ((uniform->location >= 0) &&
+		(!uniform->has_value || (memcmp(uniform->value, value, value_size) != 0)))
+	{
+		memcpy(uniform->value, value, value_size);
+		uniform->has_value = true;
+		result = true;
+	}
+	return(result);
+}
+
+internal void
+shader_set_m4(ShaderProgram *program, ShaderUniformId id, m4 *value)
+{
+	if (shader_uniform_changed(program, id, value, sizeof(*value)))
+	{
+		glUniformMatrix4fv(program->uniforms[id].location, 1, GL_FALSE, &value->Elements[0][0]);
+	}
+	else if (program->uniforms[id].location >= 0)
+	{
+		GL_COUNT_FILTERED_CALL(UniformMatrix4fv);
+	}
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+/*
+
+NOTE(Nader): What we need to write SIMD kernels over SoA arrays. SSE2 is part of x86-64
+so it is always there, AVX2 is checked for at run time (simd_get_level) and its kernels
+are compiled with SIMD_TARGET_AVX2 so the rest of the build doesn't need -mavx2. NEON
+is part of AArch64, and only AArch64 has the exact vector sqrt and divide, so 32 bit
+ARM gets the scalar loops along with everything else.
+
+Kernels must give bit identical results to their scalar loop no matter which one runs,
+otherwise replays recorded on one machine drift on another. So no FMA, no reciprocal
+approximations, and lanes do exactly the operations the scalar code does, in the same
+order.
+
+*/
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_X86 1
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SIMD_TARGET_AVX2
+#else
+#include <cpuid.h>
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+typedef enum SimdLevel
+{
+    SimdLevel_Scalar,
+    SimdLevel_SSE2,
+    SimdLevel_AVX2,
+    SimdLevel_NEON,
+
+    SimdLevel_Count,
+} SimdLevel;
+
+global char *simd_level_names[SimdLevel_Count] = {"scalar", "sse2", "avx2", "neon"};
+
+#if SIMD_X86
+internal void
+simd_cpuid(u32 leaf, u32 subleaf, u32 *registers)
+{
+#if defined(_MSC_VER)
+    __cpuidex((int *)registers, (int)leaf, (int)subleaf);
+#else
+    __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+}
+
+// NOTE(Nader): Which register state the OS saves on a context switch, AVX needs the YMM bits.
+internal u64
+simd_xgetbv(void)
+{
+#if defined(_MSC_VER)
+    u64 result = _xgetbv(0);
+#else
+    u32 low, high;
+    __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+    u64 result = ((u64)high << 32) | low;
+#endif
+    return(result);
+}
+#endif
+
+// NOTE(Nader): The widest level this machine and OS support.
+internal SimdLevel
+simd_get_level(void)
+{
+    SimdLevel result = SimdLevel_Scalar;
+#if SIMD_X86
+    result = SimdLevel_SSE2;
+    u32 registers[4];
+    simd_cpuid(0, 0, registers);
+    if (registers[0] >= 7)
+    {
+        simd_cpuid(1, 0, registers);
+        b32 has_osxsave = (registers[2] & (1 << 27)) != 0;
+        b32 has_avx = (registers[2] & (1 << 28)) != 0;
+        simd_cpuid(7, 0, registers);
+        b32 has_avx2 = (registers[1] & (1 << 5)) != 0;
+        if (has_osxsave && has_avx && has_avx2 && ((simd_xgetbv() & 0x6) == 0x6))
+        {
+            result = SimdLevel_AVX2;
+        }
+    }
+#elif SIMD_NEON
+    result = SimdLevel_NEON;
+#endif
+    return(result);
+}
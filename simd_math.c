@@ -0,0 +1,368 @@
+/*
+
+NOTE(Nader): Batched versions of the HandmadeMath operations we do in bulk, over SoA
+float arrays instead of one v3 or m4 at a time:
+
+    lerp_arrays             dest = (1 - t)*a + t*b, like HMM_Lerp
+    normalize_v3_arrays     (x, y, z) /= its length, like HMM_NormV3, zero vectors stay zero
+    transform_point_arrays  (x, y, z, 1) through one m4, like HMM_MulM4V4, w dropped
+
+Same layout as entity_integrate.c: a scalar kernel that is the reference and does the
+tails, one wide kernel per SimdLevel, and a dispatch that takes the level. Every kernel
+gives the same bits as the scalar one (see simd.h): sqrt and divide are exact in every
+instruction set, so normalizing divides by the sqrt rather than using a reciprocal
+square root estimate.
+
+Loads and stores are unaligned, so the arrays can be anywhere, and every element is
+independent, so dest can be a source array.
+
+*/
+
+internal void
+lerp_arrays_scalar(f32 *dest, f32 *a, f32 *b, f32 t, u32 first, u32 count)
+{
+    f32 one_minus_t = 1.0f - t;
+    for (u32 index = first; index < count; ++index)
+    {
+        dest[index] = one_minus_t*a[index] + t*b[index];
+    }
+}
+
+internal void
+normalize_v3_arrays_scalar(f32 *x, f32 *y, f32 *z, u32 first, u32 count)
+{
+    for (u32 index = first; index < count; ++index)
+    {
+        f32 length = sqrtf(x[index]*x[index] + y[index]*y[index] + z[index]*z[index]);
+        f32 inverse_length = (length > 0.0f) ? (1.0f / length) : 0.0f;
+        x[index] = x[index]*inverse_length;
+        y[index] = y[index]*inverse_length;
+        z[index] = z[index]*inverse_length;
+    }
+}
+
+internal void
+transform_point_arrays_scalar(m4 *matrix, f32 *dest_x, f32 *dest_y, f32 *dest_z, f32 *x, f32 *y, f32 *z,
+                              u32 first, u32 count)
+{
+    v4 column_0 = matrix->Columns[0];
+    v4 column_1 = matrix->Columns[1];
+    v4 column_2 = matrix->Columns[2];
+    v4 column_3 = matrix->Columns[3];
+    for (u32 index = first; index < count; ++index)
+    {
+        f32 point_x = x[index];
+        f32 point_y = y[index];
+        f32 point_z = z[index];
+        dest_x[index] = column_0.X*point_x + column_1.X*point_y + column_2.X*point_z + column_3.X;
+        dest_y[index] = column_0.Y*point_x + column_1.Y*point_y + column_2.Y*point_z + column_3.Y;
+        dest_z[index] = column_0.Z*point_x + column_1.Z*point_y + column_2.Z*point_z + column_3.Z;
+    }
+}
+
+#if SIMD_X86
+internal void
+lerp_arrays_sse2(f32 *dest, f32 *a, f32 *b, f32 t, u32 count)
+{
+    __m128 t_4x = _mm_set1_ps(t);
+    __m128 one_minus_t_4x = _mm_set1_ps(1.0f - t);
+    u32 wide_count = count & ~3u;
+    for (u32 index = 0; index < wide_count; index += 4)
+    {
+        __m128 from = _mm_mul_ps(one_minus_t_4x, _mm_loadu_ps(a + index));
+        __m128 to = _mm_mul_ps(t_4x, _mm_loadu_ps(b + index));
+        _mm_storeu_ps(dest + index, _mm_add_ps(from, to));
+    }
+    lerp_arrays_scalar(dest, a, b, t, wide_count, count);
+}
+
+internal void
+normalize_v3_arrays_sse2(f32 *x, f32 *y, f32 *z, u32 count)
+{
+    __m128 zero = _mm_setzero_ps();
+    __m128 one = _mm_set1_ps(1.0f);
+    u32 wide_count = count & ~3u;
+    for (u32 index = 0; index < wide_count; index += 4)
+    {
+        __m128 vx = _mm_loadu_ps(x + index);
+        __m128 vy = _mm_loadu_ps(y + index);
+        __m128 vz = _mm_loadu_ps(z + index);
+        __m128 length_squared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+        __m128 length = _mm_sqrt_ps(length_squared);
+        __m128 inverse_length = _mm_and_ps(_mm_cmpgt_ps(length, zero), _mm_div_ps(one, length));
+        _mm_storeu_ps(x + index, _mm_mul_ps(vx, inverse_length));
+        _mm_storeu_ps(y + index, _mm_mul_ps(vy, inverse_length));
+        _mm_storeu_ps(z + index, _mm_mul_ps(vz, inverse_length));
+    }
+    normalize_v3_arrays_scalar(x, y, z, wide_count, count);
+}
+
+internal void
+transform_point_arrays_sse2(m4 *matrix, f32 *dest_x, f32 *dest_y, f32 *dest_z, f32 *x, f32 *y, f32 *z,
+                            u32 count)
+{
+    // NOTE(Nader): Each matrix element broadcast across its own register, [column][row].
+    __m128 m[4][3];
+    for (u32 column = 0; column < 4; ++column)
+    {
+        for (u32 row = 0; row < 3; ++row)
+        {
+            m[column][row] = _mm_set1_ps(matrix->Elements[column][row]);
+        }
+    }
+
+    u32 wide_count = count & ~3u;
+    for (u32 index = 0; index < wide_count; index += 4)
+    {
+        __m128 px = _mm_loadu_ps(x + index);
+        __m128 py = _mm_loadu_ps(y + index);
+        __m128 pz = _mm_loadu_ps(z + index);
+        __m128 result[3];
+        for (u32 row = 0; row < 3; ++row)
+        {
+            __m128 sum = _mm_add_ps(_mm_mul_ps(m[0][row], px), _mm_mul_ps(m[1][row], py));
+            sum = _mm_add_ps(sum, _mm_mul_ps(m[2][row], pz));
+            result[row] = _mm_add_ps(sum, m[3][row]);
+        }
+        _mm_storeu_ps(dest_x + index, result[0]);
+        _mm_storeu_ps(dest_y + index, result[1]);
+        _mm_storeu_ps(dest_z + index, result[2]);
+    }
+    transform_point_arrays_scalar(matrix, dest_x, dest_y, dest_z, x, y, z, wide_count, count);
+}
+
+SIMD_TARGET_AVX2 internal void
+lerp_arrays_avx2(f32 *dest, f32 *a, f32 *b, f32 t, u32 count)
+{
+    __m256 t_8x = _mm256_set1_ps(t);
+    __m256 one_minus_t_8x = _mm256_set1_ps(1.0f - t);
+    u32 wide_count = count & ~7u;
+    for (u32 index = 0; index < wide_count; index += 8)
+    {
+        __m256 from = _mm256_mul_ps(one_minus_t_8x, _mm256_loadu_ps(a + index));
+        __m256 to = _mm256_mul_ps(t_8x, _mm256_loadu_ps(b + index));
+        _mm256_storeu_ps(dest + index, _mm256_add_ps(from, to));
+    }
+    _mm256_zeroupper();
+    lerp_arrays_scalar(dest, a, b, t, wide_count, count);
+}
+
+SIMD_TARGET_AVX2 internal void
+normalize_v3_arrays_avx2(f32 *x, f32 *y, f32 *z, u32 count)
+{
+    __m256 zero = _mm256_setzero_ps();
+    __m256 one = _mm256_set1_ps(1.0f);
+    u32 wide_count = count & ~7u;
+    for (u32 index = 0; index < wide_count; index += 8)
+    {
+        __m256 vx = _mm256_loadu_ps(x + index);
+        __m256 vy = _mm256_loadu_ps(y + index);
+        __m256 vz = _mm256_loadu_ps(z + index);
+        __m256 length_squared = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy)),
+                                              _mm256_mul_ps(vz, vz));
+        __m256 length = _mm256_sqrt_ps(length_squared);
+        __m256 inverse_length = _mm256_and_ps(_mm256_cmp_ps(length, zero, _CMP_GT_OQ),
+                                              _mm256_div_ps(one, length));
+        _mm256_storeu_ps(x + index, _mm256_mul_ps(vx, inverse_length));
+        _mm256_storeu_ps(y + index, _mm256_mul_ps(vy, inverse_length));
+        _mm256_storeu_ps(z + index, _mm256_mul_ps(vz, inverse_length));
+    }
+    _mm256_zeroupper();
+    normalize_v3_arrays_scalar(x, y, z, wide_count, count);
+}
+
+SIMD_TARGET_AVX2 internal void
+transform_point_arrays_avx2(m4 *matrix, f32 *dest_x, f32 *dest_y, f32 *dest_z, f32 *x, f32 *y, f32 *z,
+                            u32 count)
+{
+    __m256 m[4][3];
+    for (u32 column = 0; column < 4; ++column)
+    {
+        for (u32 row = 0; row < 3; ++row)
+        {
+            m[column][row] = _mm256_set1_ps(matrix->Elements[column][row]);
+        }
+    }
+
+    u32 wide_count = count & ~7u;
+    for (u32 index = 0; index < wide_count; index += 8)
+    {
+        __m256 px = _mm256_loadu_ps(x + index);
+        __m256 py = _mm256_loadu_ps(y + index);
+        __m256 pz = _mm256_loadu_ps(z + index);
+        __m256 result[3];
+        for (u32 row = 0; row < 3; ++row)
+        {
+            __m256 sum = _mm256_add_ps(_mm256_mul_ps(m[0][row], px), _mm256_mul_ps(m[1][row], py));
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(m[2][row], pz));
+            result[row] = _mm256_add_ps(sum, m[3][row]);
+        }
+        _mm256_storeu_ps(dest_x + index, result[0]);
+        _mm256_storeu_ps(dest_y + index, result[1]);
+        _mm256_storeu_ps(dest_z + index, result[2]);
+    }
+    _mm256_zeroupper();
+    transform_point_arrays_scalar(matrix, dest_x, dest_y, dest_z, x, y, z, wide_count, count);
+}
+#endif
+
+#if SIMD_NEON
+internal void
+lerp_arrays_neon(f32 *dest, f32 *a, f32 *b, f32 t, u32 count)
+{
+    float32x4_t t_4x = vdupq_n_f32(t);
+    float32x4_t one_minus_t_4x = vdupq_n_f32(1.0f - t);
+    u32 wide_count = count & ~3u;
+    for (u32 index = 0; index < wide_count; index += 4)
+    {
+        float32x4_t from = vmulq_f32(one_minus_t_4x, vld1q_f32(a + index));
+        float32x4_t to = vmulq_f32(t_4x, vld1q_f32(b + index));
+        vst1q_f32(dest + index, vaddq_f32(from, to));
+    }
+    lerp_arrays_scalar(dest, a, b, t, wide_count, count);
+}
+
+// NOTE(Nader): vsqrtq_f32 and vdivq_f32 are AArch64 only, the exact ones; vrsqrteq_f32 would not match the scalar loop.
+internal void
+normalize_v3_arrays_neon(f32 *x, f32 *y, f32 *z, u32 count)
+{
+    float32x4_t zero = vdupq_n_f32(0.0f);
+    float32x4_t one = vdupq_n_f32(1.0f);
+    u32 wide_count = count & ~3u;
+    for (u32 index = 0; index < wide_count; index += 4)
+    {
+        float32x4_t vx = vld1q_f32(x + index);
+        float32x4_t vy = vld1q_f32(y + index);
+        float32x4_t vz = vld1q_f32(z + index);
+        float32x4_t length_squared = vaddq_f32(vaddq_f32(vmulq_f32(vx, vx), vmulq_f32(vy, vy)), vmulq_f32(vz, vz));
+        float32x4_t length = vsqrtq_f32(length_squared);
+        uint32x4_t is_nonzero = vcgtq_f32(length, zero);
+        float32x4_t inverse_length = vreinterpretq_f32_u32(
+            vandq_u32(is_nonzero, vreinterpretq_u32_f32(vdivq_f32(one, length))));
+        vst1q_f32(x + index, vmulq_f32(vx, inverse_length));
+        vst1q_f32(y + index, vmulq_f32(vy, inverse_length));
+        vst1q_f32(z + index, vmulq_f32(vz, inverse_length));
+    }
+    normalize_v3_arrays_scalar(x, y, z, wide_count, count);
+}
+
+internal void
+transform_point_arrays_neon(m4 *matrix, f32 *dest_x, f32 *dest_y, f32 *dest_z, f32 *x, f32 *y, f32 *z,
+                            u32 count)
+{
+    float32x4_t m[4][3];
+    for (u32 column = 0; column < 4; ++column)
+    {
+        for (u32 row = 0; row < 3; ++row)
+        {
+            m[column][row] = vdupq_n_f32(matrix->Elements[column][row]);
+        }
+    }
+
+    u32 wide_count = count & ~3u;
+    for (u32 index = 0; index < wide_count; index += 4)
+    {
+        float32x4_t px = vld1q_f32(x + index);
+        float32x4_t py = vld1q_f32(y + index);
+        float32x4_t pz = vld1q_f32(z + index);
+        float32x4_t result[3];
+        for (u32 row = 0; row < 3; ++row)
+        {
+            // NOTE(Nader): Separate multiply and add, vfmaq would round differently from the scalar loop.
+            float32x4_t sum = vaddq_f32(vmulq_f32(m[0][row], px), vmulq_f32(m[1][row], py));
+            sum = vaddq_f32(sum, vmulq_f32(m[2][row], pz));
+            result[row] = vaddq_f32(sum, m[3][row]);
+        }
+        vst1q_f32(dest_x + index, result[0]);
+        vst1q_f32(dest_y + index, result[1]);
+        vst1q_f32(dest_z + index, result[2]);
+    }
+    transform_point_arrays_scalar(matrix, dest_x, dest_y, dest_z, x, y, z, wide_count, count);
+}
+#endif
+
+internal void
+lerp_arrays(SimdLevel level, f32 *dest, f32 *a, f32 *b, f32 t, u32 count)
+{
+    switch (level)
+    {
+#if SIMD_X86
+    case SimdLevel_AVX2:
+    {
+        lerp_arrays_avx2(dest, a, b, t, count);
+    } break;
+    case SimdLevel_SSE2:
+    {
+        lerp_arrays_sse2(dest, a, b, t, count);
+    } break;
+#endif
+#if SIMD_NEON
+    case SimdLevel_NEON:
+    {
+        lerp_arrays_neon(dest, a, b, t, count);
+    } break;
+#endif
+    default:
+    {
+        lerp_arrays_scalar(dest, a, b, t, 0, count);
+    } break;
+    }
+}
+
+internal void
+normalize_v3_arrays(SimdLevel level, f32 *x, f32 *y, f32 *z, u32 count)
+{
+    switch (level)
+    {
+#if SIMD_X86
+    case SimdLevel_AVX2:
+    {
+        normalize_v3_arrays_avx2(x, y, z, count);
+    } break;
+    case SimdLevel_SSE2:
+    {
+        normalize_v3_arrays_sse2(x, y, z, count);
+    } break;
+#endif
+#if SIMD_NEON
+    case SimdLevel_NEON:
+    {
+        normalize_v3_arrays_neon(x, y, z, count);
+    } break;
+#endif
+    default:
+    {
+        normalize_v3_arrays_scalar(x, y, z, 0, count);
+    } break;
+    }
+}
+
+// NOTE(Nader): For affine matrices, the point's w is taken as 1 and the result's is never computed.
+internal void
+transform_point_arrays(SimdLevel level, m4 *matrix, f32 *dest_x, f32 *dest_y, f32 *dest_z,
+                       f32 *x, f32 *y, f32 *z, u32 count)
+{
+    switch (level)
+    {
+#if SIMD_X86
+    case SimdLevel_AVX2:
+    {
+        transform_point_arrays_avx2(matrix, dest_x, dest_y, dest_z, x, y, z, count);
+    } break;
+    case SimdLevel_SSE2:
+    {
+        transform_point_arrays_sse2(matrix, dest_x, dest_y, dest_z, x, y, z, count);
+    } break;
+#endif
+#if SIMD_NEON
+    case SimdLevel_NEON:
+    {
+        transform_point_arrays_neon(matrix, dest_x, dest_y, dest_z, x, y, z, count);
+    } break;
+#endif
+    default:
+    {
+        transform_point_arrays_scalar(matrix, dest_x, dest_y, dest_z, x, y, z, 0, count);
+    } break;
+    }
+}
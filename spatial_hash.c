@@ -0,0 +1,658 @@
+/*
+
+NOTE(Nader): SpatialHash operations, see spatial_hash.h for the layout.
+
+*/
+
+internal void
+initialize_spatial_hash(SpatialHash *hash, MemoryArena *arena, f32 cell_size, u32 max_box_count)
+{
+    hash->cell_size = cell_size;
+    hash->inverse_cell_size = 1.0f / cell_size;
+
+    u32 shift = SPATIAL_HASH_MIN_TABLE_SHIFT;
+    while ((1u << shift) < 4*max_box_count)
+    {
+        ++shift;
+    }
+    hash->max_cell_count = 1u << shift;
+    hash->cell_table_shift = shift;
+    hash->cell_table_shift_y = (shift + 1) / 2;
+    hash->cell_table_mask_x = (1u << hash->cell_table_shift_y) - 1;
+    hash->cell_table_mask_y = (1u << (shift - hash->cell_table_shift_y)) - 1;
+    hash->cells = push_array(arena, hash->max_cell_count, SpatialHashCell);
+    for (u32 cell_index = 0; cell_index < hash->max_cell_count; ++cell_index)
+    {
+        hash->cells[cell_index].first_box = 0;
+        hash->cells[cell_index].box_count = 0;
+    }
+    hash->cell_count = 0;
+    hash->occupied_cells = push_array(arena, max_box_count, u32);
+
+    hash->max_box_count = max_box_count;
+    hash->box_count = 0;
+    SpatialHashBoxes *box_buffers[2] = {&hash->boxes, &hash->spare_boxes};
+    for (u32 buffer_index = 0; buffer_index < array_count(box_buffers); ++buffer_index)
+    {
+        // NOTE(Nader): The pair search reads a window past the last box, see spatial_hash_find_pairs,
+        // and update reads handles a prefetch past it.
+        SpatialHashBoxes *boxes = box_buffers[buffer_index];
+        boxes->min_x = push_array(arena, max_box_count + SPATIAL_HASH_WINDOW_SIZE, f32);
+        boxes->min_y = push_array(arena, max_box_count + SPATIAL_HASH_WINDOW_SIZE, f32);
+        boxes->max_x = push_array(arena, max_box_count + SPATIAL_HASH_WINDOW_SIZE, f32);
+        boxes->max_y = push_array(arena, max_box_count + SPATIAL_HASH_WINDOW_SIZE, f32);
+        boxes->handles = push_array(arena, max_box_count + SPATIAL_HASH_PREFETCH_DISTANCE, EntityHandle);
+    }
+
+    hash->update_index = 0;
+    hash->moved_count = 0;
+    for (u32 buffer_index = 0; buffer_index < array_count(hash->sort_keys); ++buffer_index)
+    {
+        hash->sort_keys[buffer_index] = push_array(arena, max_box_count, u32);
+        hash->sort_slots[buffer_index] = push_array(arena, max_box_count, u32);
+    }
+    // NOTE(Nader): One per entity slot. Generation 0 is never live, so every slot starts out needing sorting in.
+    hash->entries = push_array(arena, max_box_count, SpatialHashEntry);
+    for (u32 slot = 0; slot < max_box_count; ++slot)
+    {
+        hash->entries[slot].key = SPATIAL_HASH_NONE;
+        hash->entries[slot].generation = 0;
+        hash->entries[slot].update_index = 0;
+    }
+}
+
+// NOTE(Nader): floorf is a libm call without SSE4.1 and this runs for every entity every frame.
+internal i32
+spatial_hash_floor(f32 value)
+{
+    i32 result = (i32)value;
+    if ((f32)result > value)
+    {
+        --result;
+    }
+    return(result);
+}
+
+// NOTE(Nader): The table entry cell (cell_x, cell_y) wraps onto.
+internal u32
+get_spatial_hash_cell(SpatialHash *hash, i32 cell_x, i32 cell_y)
+{
+    u32 result = ((((u32)cell_y & hash->cell_table_mask_y) << hash->cell_table_shift_y) |
+                  ((u32)cell_x & hash->cell_table_mask_x));
+    return(result);
+}
+
+// NOTE(Nader): The table entry a box goes in, the one its min corner is in. Boxes don't store it, it is cheaper to work out again.
+internal u32
+get_spatial_hash_box_cell(SpatialHash *hash, f32 min_x, f32 min_y)
+{
+    u32 result = get_spatial_hash_cell(hash, spatial_hash_floor(min_x*hash->inverse_cell_size),
+                                       spatial_hash_floor(min_y*hash->inverse_cell_size));
+    return(result);
+}
+
+/*
+
+NOTE(Nader): Sorts the first count keys in sort_keys[0], and their slots along with them,
+least significant digit first, in as few equal passes as fit SPATIAL_HASH_RADIX_BITS.
+Returns which of the buffers the result ended up in.
+
+*/
+internal u32
+spatial_hash_radix_sort(SpatialHash *hash, u32 count)
+{
+    u32 pass_count = (hash->cell_table_shift + SPATIAL_HASH_RADIX_BITS - 1) / SPATIAL_HASH_RADIX_BITS;
+    u32 radix_bits = (hash->cell_table_shift + pass_count - 1) / pass_count;
+    u32 radix_mask = (1u << radix_bits) - 1;
+    u32 offsets[1 << SPATIAL_HASH_RADIX_BITS];
+
+    u32 source = 0;
+    for (u32 pass_index = 0; pass_index < pass_count; ++pass_index)
+    {
+        u32 shift = pass_index*radix_bits;
+        u32 *source_keys = hash->sort_keys[source];
+        u32 *source_slots = hash->sort_slots[source];
+        u32 *dest_keys = hash->sort_keys[source ^ 1];
+        u32 *dest_slots = hash->sort_slots[source ^ 1];
+
+        for (u32 digit = 0; digit <= radix_mask; ++digit)
+        {
+            offsets[digit] = 0;
+        }
+        for (u32 index = 0; index < count; ++index)
+        {
+            ++offsets[(source_keys[index] >> shift) & radix_mask];
+        }
+        u32 total = 0;
+        for (u32 digit = 0; digit <= radix_mask; ++digit)
+        {
+            u32 digit_count = offsets[digit];
+            offsets[digit] = total;
+            total += digit_count;
+        }
+
+        for (u32 index = 0; index < count; ++index)
+        {
+            u32 dest = offsets[(source_keys[index] >> shift) & radix_mask]++;
+            dest_keys[dest] = source_keys[index];
+            dest_slots[dest] = source_slots[index];
+        }
+        source ^= 1;
+    }
+    return(source);
+}
+
+/*
+
+NOTE(Nader): Three steps:
+
+    1. Every live entity's box is read into its slot's entry, in dense order, so the
+       entries are written front to back. The ones whose table entry changed since the
+       last update, or that are new to their slot, go on a list.
+    2. That list is radix sorted. It is a few percent of the entities in a normal
+       frame, everyone on the first.
+    3. Last frame's boxes are merged with the sorted list into spare_boxes, in order,
+       taking each box's bounds from its entry. Boxes whose entity moved to another
+       table entry or was removed are dropped on the way. Everything is sorted already,
+       so this is one pass, and the runs and occupied list fall out of it. The entries
+       are the only thing it reads out of order, so they are prefetched a little ahead.
+
+*/
+internal void
+spatial_hash_update(SpatialHash *hash, EntityStore *store)
+{
+    asserts(store->count <= hash->max_box_count);
+    asserts(store->slot_count <= hash->max_box_count);
+
+    SpatialHashBoxes *old_boxes = &hash->boxes;
+    SpatialHashEntry *entries = hash->entries;
+    u32 update_index = ++hash->update_index;
+    u32 *moved_keys = hash->sort_keys[0];
+    u32 *moved_slots = hash->sort_slots[0];
+    u32 moved_count = 0;
+    for (u32 index = 0; index < store->count; ++index)
+    {
+        asserts((store->size_x[index] <= hash->cell_size) && (store->size_y[index] <= hash->cell_size));
+        u32 key = get_spatial_hash_box_cell(hash, store->position_x[index], store->position_y[index]);
+        u32 slot = store->dense_to_slot[index];
+        u32 generation = store->slot_generation[slot];
+
+        SpatialHashEntry *entry = &entries[slot];
+        if ((entry->key != key) || (entry->generation != generation))
+        {
+            moved_keys[moved_count] = key;
+            moved_slots[moved_count] = slot;
+            ++moved_count;
+        }
+        entry->min_x = store->position_x[index];
+        entry->min_y = store->position_y[index];
+        entry->max_x = store->position_x[index] + store->size_x[index];
+        entry->max_y = store->position_y[index] + store->size_y[index];
+        entry->key = key;
+        entry->generation = generation;
+        entry->update_index = update_index;
+    }
+    hash->moved_count = moved_count;
+
+    u32 sorted = spatial_hash_radix_sort(hash, moved_count);
+    moved_keys = hash->sort_keys[sorted];
+    moved_slots = hash->sort_slots[sorted];
+
+    // NOTE(Nader): Only last frame's entries can have anything in them.
+    for (u32 occupied_index = 0; occupied_index < hash->cell_count; ++occupied_index)
+    {
+        hash->cells[hash->occupied_cells[occupied_index]].box_count = 0;
+    }
+
+    // NOTE(Nader): Everything the merge writes through is copied out of hash first, or every store would make the compiler load it again.
+    SpatialHashBoxes boxes = hash->spare_boxes;
+    SpatialHashCell *cells = hash->cells;
+    u32 *occupied_cells = hash->occupied_cells;
+    u32 cell_count = 0;
+    u32 box_count = 0;
+    u32 previous_key = SPATIAL_HASH_NONE;
+
+    // NOTE(Nader): The next old box's key, NONE once they run out so whatever is left of the list goes after them.
+    u32 old_box_count = hash->box_count;
+    u32 old_box_index = 0;
+    u32 old_key = SPATIAL_HASH_NONE;
+    if (old_box_count)
+    {
+        old_key = get_spatial_hash_box_cell(hash, old_boxes->min_x[0], old_boxes->min_y[0]);
+    }
+    u32 moved_index = 0;
+    for (;;)
+    {
+        u32 key;
+        EntityHandle handle;
+        SpatialHashEntry *entry;
+        if ((moved_index < moved_count) && (moved_keys[moved_index] <= old_key))
+        {
+            key = moved_keys[moved_index];
+            handle.slot = moved_slots[moved_index];
+            entry = &entries[handle.slot];
+            handle.generation = entry->generation;
+            ++moved_index;
+        }
+        else if (old_box_index < old_box_count)
+        {
+            key = old_key;
+            handle = old_boxes->handles[old_box_index];
+            entry = &entries[handle.slot];
+#if SIMD_X86
+            _mm_prefetch((char *)&entries[old_boxes->handles[old_box_index + SPATIAL_HASH_PREFETCH_DISTANCE].slot], _MM_HINT_T0);
+#endif
+            ++old_box_index;
+            old_key = SPATIAL_HASH_NONE;
+            if (old_box_index < old_box_count)
+            {
+                old_key = get_spatial_hash_box_cell(hash, old_boxes->min_x[old_box_index], old_boxes->min_y[old_box_index]);
+            }
+
+            // NOTE(Nader): Still live, in the same entry, and not a new entity that took over a removed one's slot.
+            if ((entry->update_index != update_index) || (entry->key != key) || (entry->generation != handle.generation))
+            {
+                continue;
+            }
+        }
+        else
+        {
+            break;
+        }
+
+        u32 box_index = box_count++;
+        boxes.min_x[box_index] = entry->min_x;
+        boxes.min_y[box_index] = entry->min_y;
+        boxes.max_x[box_index] = entry->max_x;
+        boxes.max_y[box_index] = entry->max_y;
+        boxes.handles[box_index] = handle;
+
+        // NOTE(Nader): Whether a box starts a run is a coin flip, so the occupied list is always written and only sometimes kept.
+        SpatialHashCell *cell = &cells[key];
+        u32 starts_run = (key != previous_key);
+        cell->first_box = starts_run ? box_index : cell->first_box;
+        ++cell->box_count;
+        occupied_cells[cell_count] = key;
+        cell_count += starts_run;
+        previous_key = key;
+    }
+    asserts(box_count == store->count);
+    hash->box_count = box_count;
+    hash->cell_count = cell_count;
+
+    SpatialHashBoxes swap = hash->boxes;
+    hash->boxes = hash->spare_boxes;
+    hash->spare_boxes = swap;
+}
+
+/*
+
+NOTE(Nader): Writes every entity whose box overlaps [min, max] into results, up to
+max_result_count of them, and returns how many it wrote.
+
+*/
+internal u32
+spatial_hash_query_aabb(SpatialHash *hash, v2 min, v2 max, EntityHandle *results, u32 max_result_count)
+{
+    u32 result_count = 0;
+    // NOTE(Nader): Boxes reach at most one cell up and right of the cell they are in.
+    i32 min_cell_x = spatial_hash_floor(min.X*hash->inverse_cell_size) - 1;
+    i32 min_cell_y = spatial_hash_floor(min.Y*hash->inverse_cell_size) - 1;
+    i32 max_cell_x = spatial_hash_floor(max.X*hash->inverse_cell_size);
+    i32 max_cell_y = spatial_hash_floor(max.Y*hash->inverse_cell_size);
+    // NOTE(Nader): Past the size of the table the same entries come round again, and their boxes would be reported twice.
+    max_cell_x = HMM_MIN(max_cell_x, min_cell_x + (i32)hash->cell_table_mask_x);
+    max_cell_y = HMM_MIN(max_cell_y, min_cell_y + (i32)hash->cell_table_mask_y);
+    for (i32 cell_y = min_cell_y; cell_y <= max_cell_y; ++cell_y)
+    {
+        for (i32 cell_x = min_cell_x; cell_x <= max_cell_x; ++cell_x)
+        {
+            SpatialHashCell *cell = &hash->cells[get_spatial_hash_cell(hash, cell_x, cell_y)];
+            u32 end_box = cell->first_box + cell->box_count;
+            for (u32 box_index = cell->first_box; box_index < end_box; ++box_index)
+            {
+                if ((hash->boxes.min_x[box_index] < max.X) && (min.X < hash->boxes.max_x[box_index]) &&
+                    (hash->boxes.min_y[box_index] < max.Y) && (min.Y < hash->boxes.max_y[box_index]) &&
+                    (result_count < max_result_count))
+                {
+                    results[result_count++] = hash->boxes.handles[box_index];
+                }
+            }
+        }
+    }
+    return(result_count);
+}
+
+/*
+
+NOTE(Nader): Slab test. Returns the t where the ray enters the box, or a negative number
+when it misses. A zero direction component never crosses that axis's slabs, and
+(min - origin)*inverse_direction is NaN when the origin sits right on one, so that axis
+is tested on the origin instead: inside the slab for every t, or for none.
+
+*/
+internal f32
+ray_box_entry(v2 origin, v2 direction, v2 inverse_direction, f32 min_x, f32 min_y, f32 max_x, f32 max_y)
+{
+    f32 t_enter = -1e30f;
+    f32 t_exit = 1e30f;
+    if (direction.X != 0.0f)
+    {
+        f32 t0_x = (min_x - origin.X)*inverse_direction.X;
+        f32 t1_x = (max_x - origin.X)*inverse_direction.X;
+        t_enter = HMM_MIN(t0_x, t1_x);
+        t_exit = HMM_MAX(t0_x, t1_x);
+    }
+    else if ((origin.X < min_x) || (origin.X > max_x))
+    {
+        t_exit = -1.0f;
+    }
+    if (direction.Y != 0.0f)
+    {
+        f32 t0_y = (min_y - origin.Y)*inverse_direction.Y;
+        f32 t1_y = (max_y - origin.Y)*inverse_direction.Y;
+        t_enter = HMM_MAX(t_enter, HMM_MIN(t0_y, t1_y));
+        t_exit = HMM_MIN(t_exit, HMM_MAX(t0_y, t1_y));
+    }
+    else if ((origin.Y < min_y) || (origin.Y > max_y))
+    {
+        t_exit = -1.0f;
+    }
+
+    f32 result = -1.0f;
+    if ((t_exit >= t_enter) && (t_exit >= 0.0f))
+    {
+        result = HMM_MAX(t_enter, 0.0f);
+    }
+    return(result);
+}
+
+/*
+
+NOTE(Nader): First entity hit by origin + t*direction for t in [0, max_t]. Walks the
+grid cell by cell along the ray (Amanatides & Woo) and stops as soon as the closest hit
+so far comes before the point where the ray leaves the current cell. Returns the null
+handle when nothing is hit, hit_t gets the t of the hit.
+
+*/
+internal EntityHandle
+spatial_hash_raycast(SpatialHash *hash, v2 origin, v2 direction, f32 max_t, f32 *hit_t)
+{
+    u32 hit_box = SPATIAL_HASH_NONE;
+    f32 best_t = max_t;
+
+    f32 cell_size = hash->cell_size;
+    v2 inverse_direction = v2(1.0f / direction.X, 1.0f / direction.Y);
+    i32 cell_x = spatial_hash_floor(origin.X*hash->inverse_cell_size);
+    i32 cell_y = spatial_hash_floor(origin.Y*hash->inverse_cell_size);
+
+    i32 step_x = (direction.X > 0.0f) ? 1 : -1;
+    i32 step_y = (direction.Y > 0.0f) ? 1 : -1;
+    f32 next_t_x = 1e30f;
+    f32 next_t_y = 1e30f;
+    f32 delta_t_x = 1e30f;
+    f32 delta_t_y = 1e30f;
+    if (direction.X != 0.0f)
+    {
+        next_t_x = ((f32)(cell_x + (step_x > 0))*cell_size - origin.X)*inverse_direction.X;
+        delta_t_x = cell_size*HMM_ABS(inverse_direction.X);
+    }
+    if (direction.Y != 0.0f)
+    {
+        next_t_y = ((f32)(cell_y + (step_y > 0))*cell_size - origin.Y)*inverse_direction.Y;
+        delta_t_y = cell_size*HMM_ABS(inverse_direction.Y);
+    }
+
+    for (;;)
+    {
+        // NOTE(Nader): Anything overlapping this cell lives in it or one cell left and/or below.
+        for (i32 offset_y = -1; offset_y <= 0; ++offset_y)
+        {
+            for (i32 offset_x = -1; offset_x <= 0; ++offset_x)
+            {
+                SpatialHashCell *cell = &hash->cells[get_spatial_hash_cell(hash, cell_x + offset_x, cell_y + offset_y)];
+                u32 end_box = cell->first_box + cell->box_count;
+                for (u32 box_index = cell->first_box; box_index < end_box; ++box_index)
+                {
+                    f32 t = ray_box_entry(origin, direction, inverse_direction,
+                                          hash->boxes.min_x[box_index], hash->boxes.min_y[box_index],
+                                          hash->boxes.max_x[box_index], hash->boxes.max_y[box_index]);
+                    if ((t >= 0.0f) && (t <= best_t) && ((hit_box == SPATIAL_HASH_NONE) || (t < best_t)))
+                    {
+                        best_t = t;
+                        hit_box = box_index;
+                    }
+                }
+            }
+        }
+
+        f32 exit_t = HMM_MIN(next_t_x, next_t_y);
+        if ((exit_t >= best_t) || (exit_t > max_t))
+        {
+            break;
+        }
+        if (next_t_x < next_t_y)
+        {
+            cell_x += step_x;
+            next_t_x += delta_t_x;
+        }
+        else
+        {
+            cell_y += step_y;
+            next_t_y += delta_t_y;
+        }
+    }
+
+    EntityHandle result = {0};
+    if (hit_box != SPATIAL_HASH_NONE)
+    {
+        result = hash->boxes.handles[hit_box];
+    }
+    *hit_t = best_t;
+    return(result);
+}
+
+// NOTE(Nader): All ones when the entry has boxes in it, zero when it doesn't.
+internal u32
+spatial_hash_occupied_mask(SpatialHashCell *cell)
+{
+    u32 result = 0u - (u32)(cell->box_count != 0);
+    return(result);
+}
+
+internal u32
+spatial_hash_select(u32 mask, u32 if_set, u32 if_clear)
+{
+    u32 result = (if_set & mask) | (if_clear & ~mask);
+    return(result);
+}
+
+internal u32
+spatial_hash_write_pairs(SpatialHash *hash, u32 box_a, u32 window, u32 overlap_mask,
+                         SpatialHashPair *pairs, u32 pair_count, u32 max_pair_count)
+{
+    for (u32 lane = 0; lane < SPATIAL_HASH_WINDOW_SIZE; ++lane)
+    {
+        if ((overlap_mask & (1u << lane)) && (pair_count < max_pair_count))
+        {
+            SpatialHashPair *pair = &pairs[pair_count++];
+            pair->a = hash->boxes.handles[box_a];
+            pair->b = hash->boxes.handles[window + lane];
+        }
+    }
+    return(pair_count);
+}
+
+/*
+
+NOTE(Nader): Every pair of overlapping entities, once each. Each occupied entry is tested
+against itself and half of its neighbours, the other half test against it. The table is
+at least 8 entries on a side, so going one way round it never lands on an entry that
+would also reach back. Returns how many pairs were written.
+
+This is all branch mispredictions if written the obvious way: whether a neighbour is
+occupied is a coin flip, and most runs are zero to two boxes long, so a loop over one
+mispredicts nearly every time it ends. Instead:
+
+    The boxes are in table order, so entries next to each other in a row are next to
+    each other in the boxes too. Away from the table's left and right edges the rest of
+    this entry's run and the entry to its right are one range, and the three entries
+    above are another, found with selects rather than branches.
+
+    A range is tested a window of SPATIAL_HASH_WINDOW_SIZE boxes at a time, with the
+    ones past its end masked off, and always at least one window even when it is empty.
+    That is why the box arrays have a window spare on the end.
+
+Hardly anything overlaps, so writing a pair is the one branch that is almost never taken.
+
+*/
+internal u32
+spatial_hash_find_pairs(SpatialHash *hash, SpatialHashPair *pairs, u32 max_pair_count)
+{
+    local_persist i32 neighbour_offsets[4][2] = {{1, 0}, {-1, 1}, {0, 1}, {1, 1}};
+
+    u32 pair_count = 0;
+    for (u32 occupied_index = 0; occupied_index < hash->cell_count; ++occupied_index)
+    {
+        u32 cell_index = hash->occupied_cells[occupied_index];
+        SpatialHashCell *cell = &hash->cells[cell_index];
+        i32 table_x = (i32)(cell_index & hash->cell_table_mask_x);
+        i32 table_y = (i32)(cell_index >> hash->cell_table_shift_y);
+        SpatialHashCell *neighbours[4];
+        for (u32 neighbour_index = 0; neighbour_index < array_count(neighbours); ++neighbour_index)
+        {
+            neighbours[neighbour_index] = &hash->cells[get_spatial_hash_cell(hash, table_x + neighbour_offsets[neighbour_index][0],
+                                                                             table_y + neighbour_offsets[neighbour_index][1])];
+        }
+
+        // NOTE(Nader): Range 0 is the rest of this entry's own run, it is filled in per box.
+        u32 end_box = cell->first_box + cell->box_count;
+        u32 first_boxes[5];
+        u32 end_boxes[5];
+        u32 range_count = 1;
+        end_boxes[0] = end_box;
+        if ((table_x > 0) && (table_x < (i32)hash->cell_table_mask_x))
+        {
+            SpatialHashCell *right = neighbours[0];
+            SpatialHashCell *above_left = neighbours[1];
+            SpatialHashCell *above = neighbours[2];
+            SpatialHashCell *above_right = neighbours[3];
+            u32 right_mask = spatial_hash_occupied_mask(right);
+            u32 above_left_mask = spatial_hash_occupied_mask(above_left);
+            u32 above_mask = spatial_hash_occupied_mask(above);
+            u32 above_right_mask = spatial_hash_occupied_mask(above_right);
+            end_boxes[0] = spatial_hash_select(right_mask, right->first_box + right->box_count, end_box);
+
+            u32 above_first_box = spatial_hash_select(above_mask, above->first_box, above_right->first_box);
+            above_first_box = spatial_hash_select(above_left_mask, above_left->first_box, above_first_box);
+            u32 above_end_box = spatial_hash_select(above_left_mask, above_left->first_box + above_left->box_count,
+                                                    above_first_box);
+            above_end_box = spatial_hash_select(above_mask, above->first_box + above->box_count, above_end_box);
+            above_end_box = spatial_hash_select(above_right_mask, above_right->first_box + above_right->box_count,
+                                                above_end_box);
+            first_boxes[range_count] = above_first_box;
+            end_boxes[range_count] = above_end_box;
+            ++range_count;
+        }
+        else
+        {
+            // NOTE(Nader): The neighbours wrapped round the table, so they can be anywhere in the boxes.
+            for (u32 neighbour_index = 0; neighbour_index < array_count(neighbours); ++neighbour_index)
+            {
+                first_boxes[range_count] = neighbours[neighbour_index]->first_box;
+                end_boxes[range_count] = neighbours[neighbour_index]->first_box + neighbours[neighbour_index]->box_count;
+                ++range_count;
+            }
+        }
+
+#if SIMD_X86
+        if ((range_count == 2) &&
+            (end_boxes[0] - cell->first_box <= SPATIAL_HASH_WINDOW_SIZE) &&
+            (end_boxes[1] - first_boxes[1] <= SPATIAL_HASH_WINDOW_SIZE))
+        {
+            // NOTE(Nader): Nearly every entry. Both ranges fit in a window, so every box in the run tests the
+            // same window above and one to its right side by side, with no loop over windows or ranges.
+            u32 above_window = first_boxes[1];
+            u32 above_lane_mask = 0xF >> (SPATIAL_HASH_WINDOW_SIZE - (end_boxes[1] - above_window));
+            __m128 above_min_x = _mm_loadu_ps(hash->boxes.min_x + above_window);
+            __m128 above_min_y = _mm_loadu_ps(hash->boxes.min_y + above_window);
+            __m128 above_max_x = _mm_loadu_ps(hash->boxes.max_x + above_window);
+            __m128 above_max_y = _mm_loadu_ps(hash->boxes.max_y + above_window);
+            for (u32 box_a = cell->first_box; box_a < end_box; ++box_a)
+            {
+                __m128 a_min_x = _mm_set1_ps(hash->boxes.min_x[box_a]);
+                __m128 a_min_y = _mm_set1_ps(hash->boxes.min_y[box_a]);
+                __m128 a_max_x = _mm_set1_ps(hash->boxes.max_x[box_a]);
+                __m128 a_max_y = _mm_set1_ps(hash->boxes.max_y[box_a]);
+
+                u32 right_window = box_a + 1;
+                u32 right_lane_mask = 0xF >> (SPATIAL_HASH_WINDOW_SIZE - (end_boxes[0] - right_window));
+                __m128 right_x = _mm_and_ps(_mm_cmplt_ps(a_min_x, _mm_loadu_ps(hash->boxes.max_x + right_window)),
+                                            _mm_cmplt_ps(_mm_loadu_ps(hash->boxes.min_x + right_window), a_max_x));
+                __m128 right_y = _mm_and_ps(_mm_cmplt_ps(a_min_y, _mm_loadu_ps(hash->boxes.max_y + right_window)),
+                                            _mm_cmplt_ps(_mm_loadu_ps(hash->boxes.min_y + right_window), a_max_y));
+                u32 right_mask = (u32)_mm_movemask_ps(_mm_and_ps(right_x, right_y)) & right_lane_mask;
+                __m128 above_x = _mm_and_ps(_mm_cmplt_ps(a_min_x, above_max_x), _mm_cmplt_ps(above_min_x, a_max_x));
+                __m128 above_y = _mm_and_ps(_mm_cmplt_ps(a_min_y, above_max_y), _mm_cmplt_ps(above_min_y, a_max_y));
+                u32 above_mask = (u32)_mm_movemask_ps(_mm_and_ps(above_x, above_y)) & above_lane_mask;
+
+                if (right_mask | above_mask)
+                {
+                    pair_count = spatial_hash_write_pairs(hash, box_a, right_window, right_mask, pairs, pair_count, max_pair_count);
+                    pair_count = spatial_hash_write_pairs(hash, box_a, above_window, above_mask, pairs, pair_count, max_pair_count);
+                }
+            }
+            continue;
+        }
+#endif
+
+        for (u32 box_a = cell->first_box; box_a < end_box; ++box_a)
+        {
+            first_boxes[0] = box_a + 1;
+#if SIMD_X86
+            __m128 a_min_x = _mm_set1_ps(hash->boxes.min_x[box_a]);
+            __m128 a_min_y = _mm_set1_ps(hash->boxes.min_y[box_a]);
+            __m128 a_max_x = _mm_set1_ps(hash->boxes.max_x[box_a]);
+            __m128 a_max_y = _mm_set1_ps(hash->boxes.max_y[box_a]);
+#else
+            f32 a_min_x = hash->boxes.min_x[box_a];
+            f32 a_min_y = hash->boxes.min_y[box_a];
+            f32 a_max_x = hash->boxes.max_x[box_a];
+            f32 a_max_y = hash->boxes.max_y[box_a];
+#endif
+            for (u32 range_index = 0; range_index < range_count; ++range_index)
+            {
+                u32 window = first_boxes[range_index];
+                u32 range_end_box = end_boxes[range_index];
+                do
+                {
+                    u32 remaining = range_end_box - window;
+                    u32 lane_mask = 0xF >> (SPATIAL_HASH_WINDOW_SIZE - HMM_MIN(remaining, SPATIAL_HASH_WINDOW_SIZE));
+#if SIMD_X86
+                    __m128 overlaps_x = _mm_and_ps(_mm_cmplt_ps(a_min_x, _mm_loadu_ps(hash->boxes.max_x + window)),
+                                                   _mm_cmplt_ps(_mm_loadu_ps(hash->boxes.min_x + window), a_max_x));
+                    __m128 overlaps_y = _mm_and_ps(_mm_cmplt_ps(a_min_y, _mm_loadu_ps(hash->boxes.max_y + window)),
+                                                   _mm_cmplt_ps(_mm_loadu_ps(hash->boxes.min_y + window), a_max_y));
+                    u32 overlap_mask = (u32)_mm_movemask_ps(_mm_and_ps(overlaps_x, overlaps_y)) & lane_mask;
+#else
+                    u32 overlap_mask = 0;
+                    for (u32 lane = 0; lane < SPATIAL_HASH_WINDOW_SIZE; ++lane)
+                    {
+                        u32 box_b = window + lane;
+                        u32 overlaps = ((a_min_x < hash->boxes.max_x[box_b]) & (hash->boxes.min_x[box_b] < a_max_x) &
+                                        (a_min_y < hash->boxes.max_y[box_b]) & (hash->boxes.min_y[box_b] < a_max_y));
+                        overlap_mask |= overlaps << lane;
+                    }
+                    overlap_mask &= lane_mask;
+#endif
+                    if (overlap_mask)
+                    {
+                        pair_count = spatial_hash_write_pairs(hash, box_a, window, overlap_mask, pairs, pair_count, max_pair_count);
+                    }
+                    window += SPATIAL_HASH_WINDOW_SIZE;
+                } while (window < range_end_box);
+            }
+        }
+    }
+    return(pair_count);
+}
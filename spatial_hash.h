@@ -0,0 +1,110 @@
+#pragma once
+
+/*
+
+NOTE(Nader): Collision broadphase. A uniform grid of cell_size cells, stored sparsely
+in a hash on the cell coordinates so the world can be any size.
+
+The hash is the cell coordinates wrapped onto a power of two sized 2D table, so cells
+that are neighbours in the world are neighbours in the table too (or a row apart), and
+the queries below, which all walk small blocks of cells, stay in cache. Cells far apart
+in the world that wrap onto the same table entry just share it. Every test against a
+box is exact, so sharing only ever costs a few extra tests, never a wrong answer.
+
+Every entity sits in exactly one cell, the one its position (the bottom left corner of
+its box) falls in. No entity may be bigger than a cell, so two boxes can only overlap
+when their cells are the same or neighbours, and a box can only reach into a cell from
+that cell or the ones to its left and below. The queries only ever look at those.
+
+spatial_hash_update runs once a frame after movement and keeps every box sorted on its
+table entry, so each occupied entry is a contiguous run of boxes and the queries never
+have to go back to the EntityStore or follow a pointer. Last frame's order is kept, and
+only the entities that changed entry since (a few percent in a normal frame) or are new
+get sorted, then merged into it in one pass that drops the ones that moved away or were
+removed. The occupied entries are kept in a dense list as well, which is what the pair
+search walks and what the next update clears, so nothing ever scans the whole table.
+
+Queries see the entities as they were at the last update and hand back EntityHandles,
+so anything removed since then simply fails to resolve.
+
+*/
+
+// NOTE(Nader): Bits sorted per radix pass, so the histogram stays in L1.
+#define SPATIAL_HASH_RADIX_BITS 11
+// NOTE(Nader): Log2 of the smallest table, 8 entries on a side, see spatial_hash_find_pairs.
+#define SPATIAL_HASH_MIN_TABLE_SHIFT 6
+#define SPATIAL_HASH_NONE 0xFFFFFFFF
+// NOTE(Nader): Boxes tested at once by the pair search, see spatial_hash_find_pairs.
+#define SPATIAL_HASH_WINDOW_SIZE 4
+// NOTE(Nader): How many boxes ahead update asks for the entry it will need, see spatial_hash_update.
+#define SPATIAL_HASH_PREFETCH_DISTANCE 16
+
+typedef struct SpatialHashCell
+{
+    // NOTE(Nader): Where this entry's run starts in the boxes, box_count is 0 when empty.
+    u32 first_box;
+    u32 box_count;
+} SpatialHashCell;
+
+// NOTE(Nader): An entity's box as update last read it, by slot. 32 bytes so it is never split across cache lines.
+typedef struct SpatialHashEntry
+{
+    f32 min_x;
+    f32 min_y;
+    f32 max_x;
+    f32 max_y;
+    u32 key;
+    u32 generation;
+    // NOTE(Nader): The update that last saw this slot live, anything older was removed.
+    u32 update_index;
+    u32 pad;
+} SpatialHashEntry;
+
+// NOTE(Nader): SoA, sorted on the table entry their min corner is in, handles[i] is whose box i is.
+typedef struct SpatialHashBoxes
+{
+    f32 *min_x;
+    f32 *min_y;
+    f32 *max_x;
+    f32 *max_y;
+    EntityHandle *handles;
+} SpatialHashBoxes;
+
+typedef struct SpatialHashPair
+{
+    EntityHandle a;
+    EntityHandle b;
+} SpatialHashPair;
+
+typedef struct SpatialHash
+{
+    f32 cell_size;
+    f32 inverse_cell_size;
+
+    // NOTE(Nader): Power of two, cell_table_mask_x + 1 wide.
+    u32 max_cell_count;
+    u32 cell_table_shift;
+    u32 cell_table_shift_y;
+    u32 cell_table_mask_x;
+    u32 cell_table_mask_y;
+    SpatialHashCell *cells;
+    // NOTE(Nader): Table index of every entry with boxes in it, in table order.
+    u32 cell_count;
+    u32 *occupied_cells;
+
+    // NOTE(Nader): Every entity's box as of the last update. The update merges into spare_boxes and swaps.
+    u32 max_box_count;
+    u32 box_count;
+    SpatialHashBoxes boxes;
+    SpatialHashBoxes spare_boxes;
+
+    // NOTE(Nader): Scratch for update, the entities that need sorting back in, as a table index and
+    // slot each, twice for the radix sort to ping-pong between.
+    u32 moved_count;
+    u32 *sort_keys[2];
+    u32 *sort_slots[2];
+
+    // NOTE(Nader): One per entity slot, and how many updates have run, see SpatialHashEntry.
+    u32 update_index;
+    SpatialHashEntry *entries;
+} SpatialHash;
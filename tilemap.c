@@ -0,0 +1,245 @@
+/*
+
+NOTE(Nader): Tilemap operations, see tilemap.h for the layout.
+
+*/
+
+global v4 tile_colors[TileType_Count] =
+{
+    {0.0f, 0.0f, 0.0f, 0.0f},
+    {0.35f, 0.33f, 0.3f, 1.0f},
+    {0.2f, 0.45f, 0.2f, 1.0f},
+    {0.15f, 0.12f, 0.12f, 1.0f},
+};
+
+internal void
+initialize_tilemap(Tilemap *tilemap, MemoryArena *arena, f32 tile_size, u32 seed)
+{
+    tilemap->tile_size = tile_size;
+    tilemap->seed = seed;
+    // NOTE(Nader): Starts at 1 so no chunk looks like it was used this frame before it has been.
+    tilemap->frame_index = 1;
+    tilemap->next_version = 0;
+
+    tilemap->resident_chunk_count = 0;
+    tilemap->chunks = push_array(arena, TILEMAP_MAX_RESIDENT_CHUNKS, TileChunk);
+    for (u32 chunk_index = 0; chunk_index < TILEMAP_MAX_RESIDENT_CHUNKS; ++chunk_index)
+    {
+        TileChunk *chunk = &tilemap->chunks[chunk_index];
+        chunk->last_used_frame = 0;
+        chunk->next_in_hash = 0;
+        chunk->instance_count = 0;
+        chunk->instances = push_array(arena, TILEMAP_CHUNK_TILE_COUNT, RenderInstance);
+    }
+    for (u32 hash_index = 0; hash_index < TILEMAP_CHUNK_HASH_COUNT; ++hash_index)
+    {
+        tilemap->chunk_hash[hash_index] = 0;
+    }
+
+    tilemap->visible_chunk_count = 0;
+    tilemap->bake_count = 0;
+    tilemap->page_in_count = 0;
+    tilemap->eviction_count = 0;
+}
+
+internal u32
+tile_hash(u32 x, u32 y, u32 seed)
+{
+    u32 result = (x*0x8DA6B343) ^ (y*0xD8163841) ^ (seed*0xCB1AB31F);
+    result ^= result >> 13;
+    result *= 0x5BD1E995;
+    result ^= result >> 15;
+    return(result);
+}
+
+internal TileChunk **
+get_tile_chunk_hash_slot(Tilemap *tilemap, i32 chunk_x, i32 chunk_y)
+{
+    u32 hash_index = tile_hash((u32)chunk_x, (u32)chunk_y, 0) & (TILEMAP_CHUNK_HASH_COUNT - 1);
+    TileChunk **result = &tilemap->chunk_hash[hash_index];
+    return(result);
+}
+
+// NOTE(Nader): Placeholder level until we load real ones: floor with patches of grass and pillars.
+internal void
+generate_tile_chunk(Tilemap *tilemap, TileChunk *chunk)
+{
+    u32 seed = tilemap->seed;
+    for (u32 tile_y = 0; tile_y < TILEMAP_CHUNK_DIM; ++tile_y)
+    {
+        for (u32 tile_x = 0; tile_x < TILEMAP_CHUNK_DIM; ++tile_x)
+        {
+            // NOTE(Nader): World tile coordinates, wrapped to u32 so negative ones hash like any other.
+            u32 world_x = (u32)chunk->chunk_x*TILEMAP_CHUNK_DIM + tile_x;
+            u32 world_y = (u32)chunk->chunk_y*TILEMAP_CHUNK_DIM + tile_y;
+
+            u32 tile = TileType_Floor;
+            if ((tile_hash(world_x, world_y, seed) % 61) == 0)
+            {
+                tile = TileType_Wall;
+            }
+            else if ((tile_hash(world_x / 4, world_y / 4, seed + 1) % 5) == 0)
+            {
+                tile = TileType_Grass;
+            }
+            chunk->tiles[tile_y*TILEMAP_CHUNK_DIM + tile_x] = (u8)tile;
+        }
+    }
+    chunk->geometry_is_dirty = true;
+}
+
+internal void
+evict_tile_chunk(Tilemap *tilemap, TileChunk *chunk)
+{
+    TileChunk **slot = get_tile_chunk_hash_slot(tilemap, chunk->chunk_x, chunk->chunk_y);
+    while (*slot != chunk)
+    {
+        asserts(*slot);
+        slot = &(*slot)->next_in_hash;
+    }
+    *slot = chunk->next_in_hash;
+    chunk->next_in_hash = 0;
+    ++tilemap->eviction_count;
+}
+
+/*
+
+NOTE(Nader): Returns the chunk at these chunk coordinates, paging it in if it isn't
+resident. Never evicts a chunk that was already used this frame, the renderer may still
+be pointing at its instances.
+
+*/
+internal TileChunk *
+get_tile_chunk(Tilemap *tilemap, i32 chunk_x, i32 chunk_y)
+{
+    TileChunk **slot = get_tile_chunk_hash_slot(tilemap, chunk_x, chunk_y);
+    TileChunk *result = *slot;
+    while (result && ((result->chunk_x != chunk_x) || (result->chunk_y != chunk_y)))
+    {
+        result = result->next_in_hash;
+    }
+
+    if (!result)
+    {
+        if (tilemap->resident_chunk_count < TILEMAP_MAX_RESIDENT_CHUNKS)
+        {
+            result = &tilemap->chunks[tilemap->resident_chunk_count++];
+        }
+        else
+        {
+            result = &tilemap->chunks[0];
+            for (u32 chunk_index = 1; chunk_index < TILEMAP_MAX_RESIDENT_CHUNKS; ++chunk_index)
+            {
+                if (tilemap->chunks[chunk_index].last_used_frame < result->last_used_frame)
+                {
+                    result = &tilemap->chunks[chunk_index];
+                }
+            }
+            asserts(result->last_used_frame != tilemap->frame_index);
+            evict_tile_chunk(tilemap, result);
+        }
+
+        result->chunk_x = chunk_x;
+        result->chunk_y = chunk_y;
+        result->next_in_hash = *slot;
+        *slot = result;
+        generate_tile_chunk(tilemap, result);
+        ++tilemap->page_in_count;
+    }
+
+    result->last_used_frame = tilemap->frame_index;
+    return(result);
+}
+
+// NOTE(Nader): Rounds toward negative infinity, tile -1 is in chunk -1.
+internal i32
+get_chunk_coordinate(i32 tile_coordinate)
+{
+    i32 result = (tile_coordinate >= 0) ?
+        (tile_coordinate / TILEMAP_CHUNK_DIM) : -((-tile_coordinate - 1) / TILEMAP_CHUNK_DIM) - 1;
+    return(result);
+}
+
+internal u32
+get_tile(Tilemap *tilemap, i32 tile_x, i32 tile_y)
+{
+    i32 chunk_x = get_chunk_coordinate(tile_x);
+    i32 chunk_y = get_chunk_coordinate(tile_y);
+    TileChunk *chunk = get_tile_chunk(tilemap, chunk_x, chunk_y);
+    u32 result = chunk->tiles[(tile_y - chunk_y*TILEMAP_CHUNK_DIM)*TILEMAP_CHUNK_DIM + (tile_x - chunk_x*TILEMAP_CHUNK_DIM)];
+    return(result);
+}
+
+internal void
+bake_tile_chunk(Tilemap *tilemap, TileChunk *chunk)
+{
+    f32 tile_size = tilemap->tile_size;
+    f32 half_tile_size = 0.5f*tile_size;
+    f32 chunk_origin_x = (f32)chunk->chunk_x*(f32)TILEMAP_CHUNK_DIM*tile_size;
+    f32 chunk_origin_y = (f32)chunk->chunk_y*(f32)TILEMAP_CHUNK_DIM*tile_size;
+
+    chunk->instance_count = 0;
+    for (u32 tile_y = 0; tile_y < TILEMAP_CHUNK_DIM; ++tile_y)
+    {
+        for (u32 tile_x = 0; tile_x < TILEMAP_CHUNK_DIM; ++tile_x)
+        {
+            u32 tile = chunk->tiles[tile_y*TILEMAP_CHUNK_DIM + tile_x];
+            if (tile != TileType_Empty)
+            {
+                // NOTE(Nader): Checkerboard the shading so movement over a flat area is visible.
+                f32 shade = ((tile_x + tile_y) & 1) ? 0.9f : 1.0f;
+                v4 color = tile_colors[tile];
+
+                RenderInstance *instance = &chunk->instances[chunk->instance_count++];
+                instance->color = v4(color.R*shade, color.G*shade, color.B*shade, color.A);
+                instance->uv_rect = v4(0.0f, 0.0f, 1.0f, 1.0f);
+                instance->transform = transform2d_scale(v2(chunk_origin_x + ((f32)tile_x + 0.5f)*tile_size,
+                                                           chunk_origin_y + ((f32)tile_y + 0.5f)*tile_size),
+                                                        v2(half_tile_size, half_tile_size));
+            }
+        }
+    }
+
+    // NOTE(Nader): From the tilemap, not the chunk, a pool entry holding a different chunk has to look new.
+    chunk->version = ++tilemap->next_version;
+    chunk->geometry_is_dirty = false;
+    ++tilemap->bake_count;
+}
+
+/*
+
+NOTE(Nader): Pushes every chunk that overlaps the world rectangle [min, max], paging in
+and baking whatever it needs first. Only the chunks inside the rectangle are ever touched.
+Call once per frame, it is also what moves the pool's idea of the current frame forward.
+
+*/
+internal void
+push_tilemap(RenderCommands *commands, Tilemap *tilemap, v2 min, v2 max, u32 sort_key)
+{
+    ++tilemap->frame_index;
+    tilemap->visible_chunk_count = 0;
+
+    f32 chunk_size = tilemap->tile_size*(f32)TILEMAP_CHUNK_DIM;
+    i32 min_chunk_x = (i32)floorf(min.X / chunk_size);
+    i32 min_chunk_y = (i32)floorf(min.Y / chunk_size);
+    i32 max_chunk_x = (i32)floorf(max.X / chunk_size);
+    i32 max_chunk_y = (i32)floorf(max.Y / chunk_size);
+    asserts((max_chunk_x - min_chunk_x + 1)*(max_chunk_y - min_chunk_y + 1) <= TILEMAP_MAX_RESIDENT_CHUNKS / 2);
+
+    for (i32 chunk_y = min_chunk_y; chunk_y <= max_chunk_y; ++chunk_y)
+    {
+        for (i32 chunk_x = min_chunk_x; chunk_x <= max_chunk_x; ++chunk_x)
+        {
+            TileChunk *chunk = get_tile_chunk(tilemap, chunk_x, chunk_y);
+            if (chunk->geometry_is_dirty)
+            {
+                bake_tile_chunk(tilemap, chunk);
+            }
+            // NOTE(Nader): The pool entry is the static id, the version changes whenever its contents do.
+            u32 static_id = (u32)(chunk - tilemap->chunks) + 1;
+            push_static_instances(commands, chunk->instances, chunk->instance_count,
+                                  static_id, chunk->version, sort_key);
+            ++tilemap->visible_chunk_count;
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+/*
+
+NOTE(Nader): The world's ground is a grid of tiles, split into square chunks of
+TILEMAP_CHUNK_DIM by TILEMAP_CHUNK_DIM tiles. A chunk bakes its tiles into RenderInstances
+once when it is paged in, then goes to the renderer as a single static entry. Drawing
+only ever looks at the chunks under the camera, so a frame costs the same on a huge map
+as on a small one.
+
+The world is as big as i32 chunk coordinates go, so only the chunks near the camera
+are resident. They live in a fixed pool of TILEMAP_MAX_RESIDENT_CHUNKS and are found
+through a hash on their coordinates. Touching a chunk that isn't resident pages it in,
+taking a free pool entry or evicting the one that went longest without being used, so
+memory use is the same whatever the size of the world.
+
+A chunk's tiles are a pure function of the seed and its coordinates, so paging in is
+generating it and paging out is forgetting it. That is also why tiles are read only:
+an edit would be gone the next time its chunk got evicted, and the tilemap is transient
+state the replays don't capture anyway. Edits belong in GameState, applied over the
+generated tiles on page in.
+
+Tile (0, 0) has its bottom left corner at the world origin, tiles are tile_size world
+units on a side.
+
+*/
+
+#define TILEMAP_CHUNK_DIM 16
+#define TILEMAP_CHUNK_TILE_COUNT (TILEMAP_CHUNK_DIM*TILEMAP_CHUNK_DIM)
+
+// NOTE(Nader): Has to cover everything on screen in a frame with room to spare.
+#define TILEMAP_MAX_RESIDENT_CHUNKS 256
+// NOTE(Nader): Power of two, twice the pool so chains stay short.
+#define TILEMAP_CHUNK_HASH_COUNT 512
+
+typedef enum TileType
+{
+    TileType_Empty,
+    TileType_Floor,
+    TileType_Grass,
+    TileType_Wall,
+
+    TileType_Count,
+} TileType;
+
+typedef struct TileChunk
+{
+    i32 chunk_x;
+    i32 chunk_y;
+    b32 is_resident;
+    u32 last_used_frame;
+    struct TileChunk *next_in_hash;
+
+    // NOTE(Nader): Row major, bottom row first.
+    u8 tiles[TILEMAP_CHUNK_TILE_COUNT];
+
+    b32 geometry_is_dirty;
+    // NOTE(Nader): Unique across the whole pool every bake, see RenderEntryStaticInstances.
+    u32 version;
+    u32 instance_count;
+    RenderInstance *instances;
+} TileChunk;
+
+typedef struct Tilemap
+{
+    f32 tile_size;
+    u32 seed;
+    u32 frame_index;
+    u32 next_version;
+
+    u32 resident_chunk_count;
+    TileChunk *chunks;
+    TileChunk *chunk_hash[TILEMAP_CHUNK_HASH_COUNT];
+
+    // NOTE(Nader): Stats, for the platform's report.
+    u32 visible_chunk_count;
+    u32 bake_count;
+    u32 page_in_count;
+    u32 eviction_count;
+} Tilemap;
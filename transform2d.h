@@ -0,0 +1,114 @@
+#pragma once
+
+/*
+
+NOTE(Nader): 2D affine transform, what we use instead of an m4 model matrix for anything
+that lives in the z = 0 plane. Six floats instead of sixteen, and putting a point
+through one is two multiply-adds per axis:
+
+    world = origin + p.x*x_axis + p.y*y_axis
+
+Sprites are the unit quad (-1 to 1 on x and y) put through one of these, which is also
+how they go to the GPU, see RenderInstance.
+
+*/
+
+typedef struct Transform2D
+{
+    v2 x_axis;
+    v2 y_axis;
+    v2 origin;
+} Transform2D;
+
+// NOTE(Nader): Scaled, then rotated counterclockwise by rotation radians, then moved to origin.
+internal Transform2D
+transform2d(v2 origin, v2 scale, f32 rotation)
+{
+    Transform2D result;
+    f32 cos_rotation = HMM_CosF(rotation);
+    f32 sin_rotation = HMM_SinF(rotation);
+    result.x_axis = v2(scale.X*cos_rotation, scale.X*sin_rotation);
+    result.y_axis = v2(-scale.Y*sin_rotation, scale.Y*cos_rotation);
+    result.origin = origin;
+    return(result);
+}
+
+// NOTE(Nader): transform2d with no rotation, without the trig.
+internal Transform2D
+transform2d_scale(v2 origin, v2 scale)
+{
+    Transform2D result;
+    result.x_axis = v2(scale.X, 0.0f);
+    result.y_axis = v2(0.0f, scale.Y);
+    result.origin = origin;
+    return(result);
+}
+
+internal v2
+transform2d_point(Transform2D transform, v2 point)
+{
+    v2 result;
+    result.X = transform.origin.X + point.X*transform.x_axis.X + point.Y*transform.y_axis.X;
+    result.Y = transform.origin.Y + point.X*transform.x_axis.Y + point.Y*transform.y_axis.Y;
+    return(result);
+}
+
+// NOTE(Nader): b first, then a, like HMM_MulM4(a, b).
+internal Transform2D
+transform2d_multiply(Transform2D a, Transform2D b)
+{
+    Transform2D result;
+    result.x_axis.X = a.x_axis.X*b.x_axis.X + a.y_axis.X*b.x_axis.Y;
+    result.x_axis.Y = a.x_axis.Y*b.x_axis.X + a.y_axis.Y*b.x_axis.Y;
+    result.y_axis.X = a.x_axis.X*b.y_axis.X + a.y_axis.X*b.y_axis.Y;
+    result.y_axis.Y = a.x_axis.Y*b.y_axis.X + a.y_axis.Y*b.y_axis.Y;
+    result.origin = transform2d_point(a, b.origin);
+    return(result);
+}
+
+// NOTE(Nader): For anything that still wants a model matrix.
+internal m4
+transform2d_to_m4(Transform2D transform)
+{
+    m4 result = m4_diagonal(1.0f);
+    result.Columns[0] = v4(transform.x_axis.X, transform.x_axis.Y, 0.0f, 0.0f);
+    result.Columns[1] = v4(transform.y_axis.X, transform.y_axis.Y, 0.0f, 0.0f);
+    result.Columns[3] = v4(transform.origin.X, transform.origin.Y, 0.0f, 1.0f);
+    return(result);
+}
+
+/*
+
+NOTE(Nader): Batch versions, for whole arrays at once. Plain loops over flat arrays with
+nothing but multiply-adds in them, so the compiler vectorizes them. dest may be children.
+
+*/
+internal void
+transform2d_multiply_batch(Transform2D *dest, Transform2D parent, Transform2D *children, u32 count)
+{
+    for (u32 index = 0; index < count; ++index)
+    {
+        dest[index] = transform2d_multiply(parent, children[index]);
+    }
+}
+
+/*
+
+NOTE(Nader): The unit quad transforms for count axis aligned boxes given SoA, the way the
+EntityStore keeps them: x/y is each box's bottom left corner, and the quad is centered on
+the box and scaled to half its size.
+
+*/
+internal void
+transform2d_boxes_batch(Transform2D *dest, f32 *x, f32 *y, f32 *size_x, f32 *size_y, u32 count)
+{
+    for (u32 index = 0; index < count; ++index)
+    {
+        f32 half_size_x = 0.5f*size_x[index];
+        f32 half_size_y = 0.5f*size_y[index];
+        Transform2D *transform = &dest[index];
+        transform->x_axis = v2(half_size_x, 0.0f);
+        transform->y_axis = v2(0.0f, half_size_y);
+        transform->origin = v2(x[index] + half_size_x, y[index] + half_size_y);
+    }
+}
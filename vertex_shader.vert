@@ -1,11 +1,25 @@
 #version 330 core
 
+// NOTE(Nader): Per vertex, the unit sprite quad.
 layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aUV;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+// NOTE(Nader): Per instance, see RenderInstance in renderer.h.
+layout (location = 2) in vec4 aColor;
+layout (location = 3) in vec4 aUVRect;
+// NOTE(Nader): The Transform2D, x axis in xy and y axis in zw.
+layout (location = 4) in vec4 aAxes;
+layout (location = 5) in vec2 aOrigin;
+
+// NOTE(Nader): Projection times view, multiplied once on the CPU.
+uniform mat4 view_projection;
+
+out vec4 vertex_color;
+out vec2 vertex_uv;
 
 void main() {
-	gl_Position = projection * model * view * vec4(aPos, 1.0);
-}
\ No newline at end of file
+	vec2 world = aOrigin + aPos.x*aAxes.xy + aPos.y*aAxes.zw;
+	gl_Position = view_projection * vec4(world, 0.0, 1.0);
+	vertex_color = aColor;
+	vertex_uv = aUVRect.xy + aUV*aUVRect.zw;
+}
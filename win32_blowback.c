@@ -1,16 +1,30 @@
-#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
 #include <windows.h>
 #include <xinput.h>
 
 #include "platform.h"
+#include "frame_pacer.h"
+#include "profiler.h"
+#include "memory_arena.h"
+#include "transform2d.h"
+#include "renderer.h"
+#include "simd.h"
+#include "entity.h"
+#include "tilemap.h"
+#include "spatial_hash.h"
+#include "asset_pack.h"
+#include "asset.h"
+#include "camera.h"
 #include "blowback.h"
+#include "work_queue.h"
 #define GL_LITE_IMPLEMENTATION
 #include "gl_lite.h"
-#include "win32_blowback.h"
+#include "gl_state_cache.h"
 
 #include "shader.c"
-#include "blowback.c"
+#include "renderer_opengl.c"
+#include "replay.c"
+
+#include "win32_blowback.h"
 
 /*
 
@@ -18,8 +32,6 @@
 
 	- Saved game locations
 	- Getting a handle to our own executable ifle
-	- Asset loading path
-	- Threading (launch a thread)
 	- Raw Input (support for multiple keyboards) (?)
 	- ClipCursor() (for multimonitor support)
 	- Fullscreen support
@@ -38,13 +50,8 @@ NOTE(Nader): WORD is Windows for 16-bit unsigned integer
 NOTE(Nader): DWORD is Windows for 32-bit value unsigned integer
 NOTE(Nader): SHORT is Windows 16-bit signed value
 
-TODO(Nader): Render a tile map
 TODO(Nader): Have the camera follow the player as he travels between different tilemaps
 	- Then I'll have an understanding of rendering offscreen items and coordinate systems 
-TODO(Nader): Abstract away the renderer
-TODO(Nader): Implement Hot Reloading
-TODO(Nader): Have camera track player movement
-TODO(Nader): Implement playback for debugging and for replays
 
 */
 
@@ -134,6 +141,96 @@ win32_load_xinput(void)
 	}
 }
 
+// NOTE(Nader): The game DLL and friends live next to the executable, not in the working directory.
+internal void
+win32_get_exe_filename(Win32State *win32_state)
+{
+	DWORD size_of_filename = GetModuleFileNameA(0, win32_state->exe_filename, sizeof(win32_state->exe_filename));
+	win32_state->one_past_last_exe_filename_slash = win32_state->exe_filename;
+	for (char *scan = win32_state->exe_filename; *scan; ++scan)
+	{
+		if (*scan == '\\')
+		{
+			win32_state->one_past_last_exe_filename_slash = scan + 1;
+		}
+	}
+}
+
+internal void
+win32_build_exe_path_filename(Win32State *win32_state, char *filename, char *dest, int dest_count)
+{
+	_snprintf_s(dest, dest_count, _TRUNCATE, "%.*s%s",
+				(int)(win32_state->one_past_last_exe_filename_slash - win32_state->exe_filename),
+				win32_state->exe_filename, filename);
+}
+
+internal FILETIME
+win32_get_last_write_time(char *filename)
+{
+	FILETIME last_write_time = { 0 };
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (GetFileAttributesExA(filename, GetFileExInfoStandard, &data))
+	{
+		last_write_time = data.ftLastWriteTime;
+	}
+	return(last_write_time);
+}
+
+GAME_SIMULATE(game_simulate_stub)
+{
+}
+
+GAME_RENDER(game_render_stub)
+{
+}
+
+/*
+
+NOTE(Nader): Loads a copy of the DLL, so the original is free for the compiler to
+overwrite while we run. build.bat holds lock.tmp while it writes the DLL and we don't
+touch it until that is gone.
+
+*/
+internal Win32GameCode
+win32_load_game_code(char *source_dll_name, char *temp_dll_name, char *lock_file_name)
+{
+	Win32GameCode result = { 0 };
+
+	WIN32_FILE_ATTRIBUTE_DATA ignored;
+	if (!GetFileAttributesExA(lock_file_name, GetFileExInfoStandard, &ignored))
+	{
+		result.dll_last_write_time = win32_get_last_write_time(source_dll_name);
+		CopyFileA(source_dll_name, temp_dll_name, FALSE);
+		result.game_code_dll = LoadLibraryA(temp_dll_name);
+		if (result.game_code_dll)
+		{
+			result.simulate = (game_simulate_function *)GetProcAddress(result.game_code_dll, "game_simulate");
+			result.render = (game_render_function *)GetProcAddress(result.game_code_dll, "game_render");
+			result.is_valid = (result.simulate && result.render);
+		}
+	}
+
+	if (!result.is_valid)
+	{
+		result.simulate = game_simulate_stub;
+		result.render = game_render_stub;
+	}
+	return(result);
+}
+
+internal void
+win32_unload_game_code(Win32GameCode *game_code)
+{
+	if (game_code->game_code_dll)
+	{
+		FreeLibrary(game_code->game_code_dll);
+		game_code->game_code_dll = 0;
+	}
+	game_code->is_valid = false;
+	game_code->simulate = game_simulate_stub;
+	game_code->render = game_render_stub;
+}
+
 internal f32 
 win32_get_seconds_elapsed(LARGE_INTEGER start, LARGE_INTEGER end)
 {
@@ -285,8 +382,199 @@ read_file_to_memory(char *filepath)
 	return(result);
 }
 
+// NOTE(Nader): Maps the whole pack read only. Leaves pack->base 0 if there is no pack or it isn't one we understand.
+internal void
+win32_map_asset_pack(char *filepath, AssetPack *pack)
+{
+	pack->base = 0;
+	pack->size = 0;
+	HANDLE file_handle = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, 0, 0);
+	if (file_handle != INVALID_HANDLE_VALUE)
+	{
+		LARGE_INTEGER file_size;
+		if (GetFileSizeEx(file_handle, &file_size) && (file_size.QuadPart > 0))
+		{
+			HANDLE mapping = CreateFileMappingA(file_handle, 0, PAGE_READONLY, 0, 0, 0);
+			if (mapping)
+			{
+				void *base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				if (base)
+				{
+					pack->base = (u8 *)base;
+					pack->size = (u64)file_size.QuadPart;
+					if (!open_asset_pack(pack))
+					{
+						UnmapViewOfFile(base);
+						pack->base = 0;
+						pack->size = 0;
+					}
+				}
+				// NOTE(Nader): The view keeps the mapping and the file open.
+				CloseHandle(mapping);
+			}
+		}
+		CloseHandle(file_handle);
+	}
+}
+
+// NOTE(Nader): Out of the pack if it has it, otherwise the loose file next to the executable.
+internal char *
+win32_load_shader_source(Win32State *win32_state, AssetPack *pack, char *name)
+{
+	char *result = 0;
+	AssetPackEntry *entry = find_asset_pack_entry(pack, name);
+	if (entry && (entry->type == AssetPackEntryType_Text))
+	{
+		result = (char *)get_asset_pack_data(pack, entry);
+	}
+	else
+	{
+		char filepath[WIN32_STATE_FILE_NAME_COUNT];
+		win32_build_exe_path_filename(win32_state, name, filepath, sizeof(filepath));
+		FileReadResults file = read_file_to_memory(filepath);
+		result = (char *)file.contents;
+	}
+	return(result);
+}
+
+internal PLATFORM_READ_ENTIRE_FILE(win32_read_entire_file)
+{
+	PlatformFileContents result = { 0 };
+	HANDLE file_handle = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, 0, 0);
+	if (file_handle != INVALID_HANDLE_VALUE)
+	{
+		LARGE_INTEGER file_size;
+		if (GetFileSizeEx(file_handle, &file_size) &&
+			((u64)file_size.QuadPart <= get_arena_size_remaining(arena, DEFAULT_ARENA_ALIGNMENT)))
+		{
+			u32 file_size_32 = truncate_u64(file_size.QuadPart);
+			void *contents = push_size(arena, file_size_32);
+			DWORD bytes_read;
+			if (ReadFile(file_handle, contents, file_size_32, &bytes_read, 0) && (file_size_32 == bytes_read))
+			{
+				result.size = file_size_32;
+				result.contents = contents;
+			}
+		}
+		CloseHandle(file_handle);
+	}
+	return(result);
+}
+
 internal void
-win32_process_pending_messages(GameControllerInput *keyboard_controller)
+win32_begin_recording_input(Win32State *win32_state, GameMemory *game_memory)
+{
+	win32_state->recording_handle = CreateFileA(win32_state->replay_filepath, GENERIC_WRITE, 0, 0,
+												CREATE_ALWAYS, 0, 0);
+	if (win32_state->recording_handle != INVALID_HANDLE_VALUE)
+	{
+		ReplayHeader header;
+		replay_fill_header(&header, game_memory);
+
+		DWORD bytes_written;
+		WriteFile(win32_state->recording_handle, &header, sizeof(header), &bytes_written, 0);
+		WriteFile(win32_state->recording_handle, game_memory->permanent_storage,
+				  (DWORD)header.snapshot_size, &bytes_written, 0);
+
+		memset(&win32_state->last_recorded_input, 0, sizeof(win32_state->last_recorded_input));
+	}
+	else
+	{
+		// TODO(Nader): Logging
+		win32_state->recording_handle = 0;
+	}
+}
+
+internal void
+win32_end_recording_input(Win32State *win32_state)
+{
+	CloseHandle(win32_state->recording_handle);
+	win32_state->recording_handle = 0;
+}
+
+internal void
+win32_record_input(Win32State *win32_state, GameInput *new_input)
+{
+	u8 encoded_input[REPLAY_MAX_ENCODED_INPUT_SIZE];
+	u32 encoded_size = replay_encode_input(new_input, &win32_state->last_recorded_input, encoded_input);
+	DWORD bytes_written;
+	WriteFile(win32_state->recording_handle, encoded_input, encoded_size, &bytes_written, 0);
+	win32_state->last_recorded_input = *new_input;
+}
+
+internal void
+win32_begin_input_playback(Win32State *win32_state, GameMemory *game_memory)
+{
+	FileReadResults replay_file = read_file_to_memory(win32_state->replay_filepath);
+	if (replay_file.contents &&
+		replay_begin_playback(&win32_state->playback, replay_file.contents, replay_file.contents_size, game_memory))
+	{
+		win32_state->playback_memory = replay_file.contents;
+		win32_state->is_playing_back = true;
+		replay_restore_snapshot(&win32_state->playback, game_memory);
+	}
+	else
+	{
+		// TODO(Nader): Logging
+		free_file_memory(replay_file.contents);
+	}
+}
+
+internal void
+win32_end_input_playback(Win32State *win32_state)
+{
+	free_file_memory(win32_state->playback_memory);
+	win32_state->playback_memory = 0;
+	win32_state->is_playing_back = false;
+}
+
+// NOTE(Nader): Loops back to the start of the recording when it runs out.
+internal void
+win32_playback_input(Win32State *win32_state, GameMemory *game_memory, GameInput *new_input)
+{
+	if (!replay_playback_input(&win32_state->playback, new_input))
+	{
+		replay_restore_snapshot(&win32_state->playback, game_memory);
+		if (!replay_playback_input(&win32_state->playback, new_input))
+		{
+			win32_end_input_playback(win32_state);
+		}
+	}
+}
+
+internal void
+win32_write_to_file(void *context, char *text, u32 length)
+{
+	DWORD bytes_written;
+	WriteFile((HANDLE)context, text, length, &bytes_written, 0);
+}
+
+// NOTE(Nader): Prints the per block summary and last frame's GL calls, and writes the chrome trace next to the executable.
+internal void
+win32_dump_profile(Win32State *win32_state, Profiler *profiler)
+{
+	local_persist char profiler_summary[8192];
+	profiler_format_summary(profiler, profiler_summary, sizeof(profiler_summary));
+	OutputDebugStringA(profiler_summary);
+
+	local_persist char gl_call_summary[4096];
+	gl_state_cache_format_counts(gl_call_summary, sizeof(gl_call_summary));
+	OutputDebugStringA(gl_call_summary);
+
+	HANDLE trace_handle = CreateFileA(win32_state->trace_filepath, GENERIC_WRITE, 0, 0, CREATE_ALWAYS, 0, 0);
+	if (trace_handle != INVALID_HANDLE_VALUE)
+	{
+		profiler_write_chrome_trace(profiler, win32_write_to_file, trace_handle);
+		CloseHandle(trace_handle);
+	}
+	else
+	{
+		// TODO(Nader): Logging
+	}
+}
+
+internal void
+win32_process_pending_messages(Win32State *win32_state, GameControllerInput *keyboard_controller)
 {
 	MSG message = { 0 };
 	while (PeekMessage(&message, 0, 0, 0, PM_REMOVE))
@@ -330,6 +618,14 @@ win32_process_pending_messages(GameControllerInput *keyboard_controller)
 				{
 					keyboard_controller->right.ended_down = true;
 				}
+				else if (vk_code == 'L')
+				{
+					win32_state->replay_toggle_requested = true;
+				}
+				else if (vk_code == 'P')
+				{
+					win32_state->profile_dump_requested = true;
+				}
 			}
 		} break;	
 		case WM_KEYUP:
@@ -372,6 +668,61 @@ win32_process_pending_messages(GameControllerInput *keyboard_controller)
 	}
 }
 
+internal PLATFORM_ADD_ENTRY(win32_add_entry)
+{
+	if (work_queue_add_entry(queue, callback, data))
+	{
+		ReleaseSemaphore((HANDLE)queue->semaphore, 1, 0);
+	}
+}
+
+internal PLATFORM_COMPLETE_ALL_WORK(win32_complete_all_work)
+{
+	work_queue_complete_all_work(queue);
+}
+
+// NOTE(Nader): Workers live as long as the process and sleep on the semaphore whenever they run out of work.
+DWORD WINAPI
+win32_work_queue_thread_proc(LPVOID parameter)
+{
+	Win32ThreadStartup *startup = (Win32ThreadStartup *)parameter;
+	PlatformWorkQueue *queue = startup->queue;
+	work_queue_thread_index = startup->thread_index;
+	for (;;)
+	{
+		if (!work_queue_do_next_entry(queue))
+		{
+			WaitForSingleObjectEx((HANDLE)queue->semaphore, INFINITE, FALSE);
+		}
+	}
+}
+
+// NOTE(Nader): thread_count counts the calling thread, which is thread 0 and starts no thread.
+internal b32
+win32_make_work_queue(PlatformWorkQueue *queue, u32 thread_count, Win32ThreadStartup *startups)
+{
+	HANDLE semaphore = CreateSemaphoreExA(0, 0, WORK_QUEUE_MAX_THREADS*WORK_QUEUE_DEQUE_SIZE, 0, 0, SEMAPHORE_ALL_ACCESS);
+	b32 result = (semaphore != 0);
+	if (result)
+	{
+		work_queue_init(queue, thread_count, semaphore);
+		for (u32 thread_index = 1; result && (thread_index < thread_count); ++thread_index)
+		{
+			Win32ThreadStartup *startup = &startups[thread_index];
+			startup->queue = queue;
+			startup->thread_index = thread_index;
+
+			HANDLE thread = CreateThread(0, 0, win32_work_queue_thread_proc, startup, 0, 0);
+			result = (thread != 0);
+			if (result)
+			{
+				CloseHandle(thread);
+			}
+		}
+	}
+	return(result);
+}
+
 internal LARGE_INTEGER
 win32_get_wall_clock()
 {
@@ -380,6 +731,61 @@ win32_get_wall_clock()
 	return(wall_clock);
 };
 
+/*
+
+NOTE(Nader): High resolution waitable timers (Windows 10 1803 and up) wake up within a
+fraction of a millisecond and don't need timeBeginPeriod. On older systems we fall back
+to a regular waitable timer, which is only as good as the scheduler granularity.
+
+*/
+internal HANDLE
+win32_create_frame_timer(void)
+{
+	HANDLE result = CreateWaitableTimerExW(0, 0, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+	if (!result)
+	{
+		result = CreateWaitableTimerExW(0, 0, 0, TIMER_ALL_ACCESS);
+	}
+	return(result);
+}
+
+// NOTE(Nader): Sleeps until just before deadline, then spins the rest of the way.
+// Returns false if the deadline had already passed.
+internal b32
+win32_wait_for_frame_deadline(FramePacer *pacer, HANDLE frame_timer, LARGE_INTEGER deadline)
+{
+	LARGE_INTEGER now = win32_get_wall_clock();
+	f64 seconds_remaining = win32_get_seconds_elapsed(now, deadline);
+	if (seconds_remaining <= 0.0)
+	{
+		return(false);
+	}
+
+	f64 sleep_seconds = frame_pacer_sleep_seconds(pacer, seconds_remaining);
+	if ((sleep_seconds > 0.0) && frame_timer)
+	{
+		// NOTE(Nader): A negative due time is relative, in 100 ns units.
+		LARGE_INTEGER due_time;
+		due_time.QuadPart = -(i64)(sleep_seconds*10000000.0);
+		if (SetWaitableTimer(frame_timer, &due_time, 0, 0, 0, FALSE))
+		{
+			WaitForSingleObject(frame_timer, INFINITE);
+			LARGE_INTEGER woke_counter = win32_get_wall_clock();
+			frame_pacer_record_sleep(pacer, sleep_seconds, win32_get_seconds_elapsed(now, woke_counter));
+			now = woke_counter;
+		}
+	}
+
+	LARGE_INTEGER spin_start_counter = now;
+	while (now.QuadPart < deadline.QuadPart)
+	{
+		_mm_pause();
+		now = win32_get_wall_clock();
+	}
+	frame_pacer_record_spin(pacer, win32_get_seconds_elapsed(spin_start_counter, now));
+	return(true);
+}
+
 internal void
 win32_process_xinput_digital_button(DWORD x_input_button_state, GameButtonState *old_state, 
 									GameButtonState *new_state, DWORD button_bit)
@@ -399,6 +805,19 @@ WinMain(HINSTANCE instance, HINSTANCE previous_instance,
 {
 	win32_load_xinput();
 	Win32State win32_state = { 0 };
+	win32_state.replay_filepath = "blowback.rep";
+	win32_state.trace_filepath = "blowback_trace.json";
+
+	win32_get_exe_filename(&win32_state);
+	char source_game_code_dll_full_path[WIN32_STATE_FILE_NAME_COUNT];
+	char temp_game_code_dll_full_path[WIN32_STATE_FILE_NAME_COUNT];
+	char game_code_lock_full_path[WIN32_STATE_FILE_NAME_COUNT];
+	win32_build_exe_path_filename(&win32_state, "blowback.dll",
+								  source_game_code_dll_full_path, sizeof(source_game_code_dll_full_path));
+	win32_build_exe_path_filename(&win32_state, "blowback_temp.dll",
+								  temp_game_code_dll_full_path, sizeof(temp_game_code_dll_full_path));
+	win32_build_exe_path_filename(&win32_state, "lock.tmp",
+								  game_code_lock_full_path, sizeof(game_code_lock_full_path));
 
 	WNDCLASSA window_class = { 0 };
 	window_class.style = CS_HREDRAW | CS_VREDRAW | CS_OWNDC;
@@ -412,17 +831,21 @@ WinMain(HINSTANCE instance, HINSTANCE previous_instance,
 	QueryPerformanceFrequency(&performance_counter_frequency_result);
 	global_performance_counter_frequency = performance_counter_frequency_result.QuadPart;
 
+	// NOTE(Nader): Only matters for the fallback frame timer, see win32_create_frame_timer.
     UINT desired_scheduler_ms = 1;
-    b32 sleep_is_granular = (timeBeginPeriod(desired_scheduler_ms) == TIMERR_NOERROR);
+    timeBeginPeriod(desired_scheduler_ms);
  
+	// NOTE(Nader): The simulation runs at a fixed game_update_hz, frames are drawn at the
+	// monitor's rate (see game_simulate in blowback.h).
 	int monitor_refresh_rate_hz = 60;
-	int game_update_hz = monitor_refresh_rate_hz;
-	f32 target_seconds_elapsed_per_frame = 1.0f / (f32)(monitor_refresh_rate_hz);
+	int game_update_hz = 60;
+	f32 seconds_per_simulate_step = 1.0f / (f32)game_update_hz;
+
+	HANDLE frame_timer = win32_create_frame_timer();
+	FramePacer pacer;
 
     if (RegisterClassA(&window_class))
     {
-        stbi_set_flip_vertically_on_load(true);
-
         HWND window = CreateWindowExA(
             0, window_class.lpszClassName, "Blowback",
             WS_OVERLAPPEDWINDOW | WS_VISIBLE, CW_USEDEFAULT, CW_USEDEFAULT,
@@ -430,99 +853,150 @@ WinMain(HINSTANCE instance, HINSTANCE previous_instance,
         if (window)
         {
             win32_init_opengl(window);
+
+			HDC refresh_device_context = GetDC(window);
+			int win32_refresh_rate = GetDeviceCaps(refresh_device_context, VREFRESH);
+			ReleaseDC(window, refresh_device_context);
+			// NOTE(Nader): 0 and 1 mean the driver doesn't know.
+			if (win32_refresh_rate > 1)
+			{
+				monitor_refresh_rate_hz = win32_refresh_rate;
+			}
+			f32 target_seconds_elapsed_per_frame = 1.0f / (f32)monitor_refresh_rate_hz;
+			frame_pacer_init(&pacer, target_seconds_elapsed_per_frame);
             game_loop = true;
             b32 full_screen = false;
 
 			// ALLOCATE GAME MEMORY
+#if BLOWBACK_INTERNAL
+			// NOTE(Nader): Fixed address in debug builds, so pointers into game memory are the
+			// same every run and a saved snapshot of the block can be replayed as is.
+			LPVOID base_address = (LPVOID)terabytes(2);
+#else
 			LPVOID base_address = 0;
+#endif
 			GameMemory game_memory = { 0 };
 			game_memory.permanent_storage_size = megabytes(64);
-			win32_state.total_size =  game_memory.permanent_storage_size + game_memory.transient_storage_size;
-			win32_state.game_memory_block = VirtualAlloc(base_address, game_memory.permanent_storage_size,
+			game_memory.transient_storage_size = gigabytes(1);
+
+			// NOTE(Nader): One block for both, total_size has to be computed after both sizes are set.
+			win32_state.total_size = game_memory.permanent_storage_size + game_memory.transient_storage_size;
+			win32_state.game_memory_block = VirtualAlloc(base_address, (SIZE_T)win32_state.total_size,
 											MEM_RESERVE|MEM_COMMIT, PAGE_READWRITE);
+			if (!win32_state.game_memory_block)
+			{
+				// TODO(Nader): Logging
+				OutputDebugStringA("Failed to allocate game memory \n");
+				game_loop = false;
+			}
 			game_memory.permanent_storage = win32_state.game_memory_block;
 
 			// Ephemeral storage
-			game_memory.transient_storage_size = gigabytes(1);
 			game_memory.transient_storage = ((u8 *)game_memory.permanent_storage +
 											game_memory.permanent_storage_size);
 
             
-			// RENDERER SETUP
-            char* sprite_vertex_filepath = "D:\\work\\blowback\\vertex_shader.vert";
-            char* sprite_fragment_filepath = "D:\\work\\blowback\\fragment_shader.frag";
-            FileReadResults sprite_vertex_file = read_file_to_memory(sprite_vertex_filepath);
-            FileReadResults sprite_fragment_file = read_file_to_memory(sprite_fragment_filepath);
-
-            char *vertex_shader_source = (char *)sprite_vertex_file.contents;
-            char *fragment_shader_source = (char *)sprite_fragment_file.contents; 
-
-            u32 vertex_shader, fragment_shader; 
-
-            vertex_shader = glCreateShader(GL_VERTEX_SHADER);
-            glShaderSource(vertex_shader, 1, &vertex_shader_source, NULL);
-            glCompileShader(vertex_shader);
-
-            fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
-            glShaderSource(fragment_shader, 1, &fragment_shader_source, NULL);
-            glCompileShader(fragment_shader);
-
-            check_shader_errors("VERTEX", vertex_shader);
-            check_shader_errors("FRAGMENT", fragment_shader);
-
-            u32 shader_program;
-            shader_program = glCreateProgram();
-            glAttachShader(shader_program, vertex_shader);
-            glAttachShader(shader_program, fragment_shader);
-            glLinkProgram(shader_program);
-
-            check_shader_errors("PROGRAM", shader_program);
-
-            glDeleteShader(vertex_shader);
-            glDeleteShader(fragment_shader);
-
-            f32 vertices[] = {
-                1.0f, 1.0f, 0.0f,   // top right
-                1.0f, -1.0f, 0.0f,   // bottom right 
-                -1.0f, -1.0f, 0.0f,   // bottom left
-                -1.0f, 1.0f, 0.0f,   // top left 
-            };
-
-            u32 indices[] = {
-                0, 1, 3,    // first triangle
-                1, 2, 3     // second triangle
-            };
-
-            u32 vao, vbo, ebo;
-            glGenVertexArrays(1, &vao);
-            glGenBuffers(1, &vbo);
-            glGenBuffers(1, &ebo);
-
-            glBindVertexArray(vao);
+			// PROFILER SETUP
+			Profiler *profiler = (Profiler *)VirtualAlloc(0, sizeof(Profiler), MEM_RESERVE|MEM_COMMIT, PAGE_READWRITE);
+			if (profiler)
+			{
+				profiler_init(profiler);
+			}
+			global_profiler = profiler;
+			game_memory.profiler = profiler;
+
+			// WORK QUEUE SETUP
+			// NOTE(Nader): One thread per logical processor, counting this one.
+			SYSTEM_INFO system_info;
+			GetSystemInfo(&system_info);
+			u32 work_queue_thread_count = (u32)system_info.dwNumberOfProcessors;
+			if (work_queue_thread_count < 1)
+			{
+				work_queue_thread_count = 1;
+			}
+			if (work_queue_thread_count > WORK_QUEUE_MAX_THREADS)
+			{
+				work_queue_thread_count = WORK_QUEUE_MAX_THREADS;
+			}
+			PlatformWorkQueue *work_queue = (PlatformWorkQueue *)VirtualAlloc(0, sizeof(PlatformWorkQueue),
+																			  MEM_RESERVE|MEM_COMMIT, PAGE_READWRITE);
+			if (!work_queue || !win32_make_work_queue(work_queue, work_queue_thread_count,
+													  win32_state.work_queue_startups))
+			{
+				// TODO(Nader): Logging
+				OutputDebugStringA("Failed to start the work queue \n");
+				game_loop = false;
+			}
+			PlatformWorkQueue *low_priority_queue = (PlatformWorkQueue *)VirtualAlloc(0, sizeof(PlatformWorkQueue),
+																					  MEM_RESERVE|MEM_COMMIT, PAGE_READWRITE);
+			if (!low_priority_queue || !win32_make_work_queue(low_priority_queue, LOW_PRIORITY_QUEUE_THREAD_COUNT,
+															  win32_state.low_priority_queue_startups))
+			{
+				// TODO(Nader): Logging
+				OutputDebugStringA("Failed to start the low priority work queue \n");
+				game_loop = false;
+			}
+			game_memory.work_queue = work_queue;
+			game_memory.work_queue_thread_count = work_queue_thread_count;
+			game_memory.platform_add_entry = win32_add_entry;
+			game_memory.platform_complete_all_work = win32_complete_all_work;
+			game_memory.low_priority_queue = low_priority_queue;
+			game_memory.platform_read_entire_file = win32_read_entire_file;
+
+			// ASSET PACK SETUP
+			char asset_pack_full_path[WIN32_STATE_FILE_NAME_COUNT];
+			win32_build_exe_path_filename(&win32_state, "blowback.pack", asset_pack_full_path,
+										  sizeof(asset_pack_full_path));
+			AssetPack asset_pack = { 0 };
+			win32_map_asset_pack(asset_pack_full_path, &asset_pack);
+			game_memory.asset_pack = &asset_pack;
 
-            glBindBuffer(GL_ARRAY_BUFFER, vbo);
-            glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+			// RENDERER SETUP
+            char *vertex_shader_source = win32_load_shader_source(&win32_state, &asset_pack, "vertex_shader.vert");
+            char *fragment_shader_source = win32_load_shader_source(&win32_state, &asset_pack, "fragment_shader.frag");
 
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+            OpenGL opengl = { 0 };
+            opengl_init(&opengl, vertex_shader_source, fragment_shader_source);
 
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-            glEnableVertexAttribArray(0);
+			RenderCommands render_commands = { 0 };
+			render_commands.width = (u32)WINDOW_WIDTH;
+			render_commands.height = (u32)WINDOW_HEIGHT;
 
 			// INPUT SETUP
 			GameInput input[2] = {0};
 			GameInput *new_input = &input[0];
 			GameInput *old_input = &input[1];
 
+			Win32GameCode game = win32_load_game_code(source_game_code_dll_full_path,
+													  temp_game_code_dll_full_path,
+													  game_code_lock_full_path);
+
 			// START GAME LOOP TIMING  
 			LARGE_INTEGER last_counter;
 			QueryPerformanceCounter(&last_counter);
 			u64 last_cycle_count = __rdtsc();
+			i64 counts_per_frame = (i64)(target_seconds_elapsed_per_frame*(f32)global_performance_counter_frequency);
+			LARGE_INTEGER frame_deadline;
+			frame_deadline.QuadPart = last_counter.QuadPart + counts_per_frame;
+			f32 last_frame_seconds = target_seconds_elapsed_per_frame;
+			f32 unsimulated_seconds = 0.0f;
 
 			// GAME LOOP
             while (game_loop) 
 			{
+				FILETIME new_dll_write_time = win32_get_last_write_time(source_game_code_dll_full_path);
+				if (CompareFileTime(&new_dll_write_time, &game.dll_last_write_time) != 0)
+				{
+					// NOTE(Nader): Queued work points at code in the old DLL.
+					win32_complete_all_work(low_priority_queue);
+					win32_unload_game_code(&game);
+					game = win32_load_game_code(source_game_code_dll_full_path,
+												temp_game_code_dll_full_path,
+												game_code_lock_full_path);
+				}
+
 				HDC window_device_context = GetDC(window);
+				BEGIN_TIMED_BLOCK(process_input);
 
 				// TODO(Nader): Should we poll this more frequently? 
 				DWORD max_controller_count = XUSER_MAX_COUNT;
@@ -587,16 +1061,65 @@ WinMain(HINSTANCE instance, HINSTANCE previous_instance,
 					}
 				}
 
-				win32_process_pending_messages(&new_input->controllers[0]);
+				win32_process_pending_messages(&win32_state, &new_input->controllers[0]);
+
+				if (win32_state.replay_toggle_requested)
+				{
+					win32_state.replay_toggle_requested = false;
+					if (win32_state.is_playing_back)
+					{
+						win32_end_input_playback(&win32_state);
+					}
+					else if (win32_state.recording_handle)
+					{
+						win32_end_recording_input(&win32_state);
+						win32_begin_input_playback(&win32_state, &game_memory);
+					}
+					else
+					{
+						win32_begin_recording_input(&win32_state, &game_memory);
+					}
+				}
+
+				END_TIMED_BLOCK(process_input);
 
-                glViewport(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT);
-                glClearColor(0.8f, 0.2f, 0.5f, 1.0f);
-                glClear(GL_COLOR_BUFFER_BIT);
+				// SIMULATE
+				// NOTE(Nader): After a long stall (a breakpoint, dragging the window) drop the
+				// time instead of simulating all of it, or every frame after falls further behind.
+				unsimulated_seconds += last_frame_seconds;
+				if (unsimulated_seconds > WIN32_MAX_SIMULATE_STEPS_PER_FRAME*seconds_per_simulate_step)
+				{
+					unsimulated_seconds = WIN32_MAX_SIMULATE_STEPS_PER_FRAME*seconds_per_simulate_step;
+				}
+				while (unsimulated_seconds >= seconds_per_simulate_step)
+				{
+					unsimulated_seconds -= seconds_per_simulate_step;
+
+					// NOTE(Nader): Recorded and played back per step, so replays don't depend on the frame rate.
+					new_input->dt_for_frame = seconds_per_simulate_step;
+					if (win32_state.recording_handle)
+					{
+						win32_record_input(&win32_state, new_input);
+					}
+
+					if (win32_state.is_playing_back)
+					{
+						win32_playback_input(&win32_state, &game_memory, new_input);
+						new_input->dt_for_frame = seconds_per_simulate_step;
+					}
+
+					game.simulate(&game_memory, new_input);
+				}
 
-				// UPDATE & RENDER
-				game_update_and_render(&game_memory, new_input, shader_program);
+				// RENDER
+				f32 interpolation = unsimulated_seconds / seconds_per_simulate_step;
+				game.render(&game_memory, interpolation, last_frame_seconds, &render_commands);
+				opengl_render_commands(&opengl, &render_commands);
 
-				SwapBuffers(window_device_context);
+				TIMED_BLOCK(swap_buffers)
+				{
+					SwapBuffers(window_device_context);
+				}
 				ReleaseDC(window, window_device_context);
 
 				// -- END GAME LOOP TIMING --
@@ -608,57 +1131,36 @@ WinMain(HINSTANCE instance, HINSTANCE previous_instance,
 				u64 cycles_elapsed = end_cycle_count - last_cycle_count;
 				i64 counter_elapsed = end_counter.QuadPart - last_counter.QuadPart;
 				f32 work_seconds_elapsed = win32_get_seconds_elapsed(last_counter, end_counter);
-				f32 seconds_elapsed_for_frame = work_seconds_elapsed;
 
-				if(seconds_elapsed_for_frame < target_seconds_elapsed_per_frame)
+				b32 missed_frame = false;
+				TIMED_BLOCK(wait_for_frame_deadline)
 				{
-					if(sleep_is_granular)
-					{
-						DWORD sleep_ms = (DWORD)(1000.0f * (target_seconds_elapsed_per_frame - seconds_elapsed_for_frame));
-						if(sleep_ms > 0)
-						{
-							Sleep(sleep_ms);
-						}
-					}
-
-					f32 test_seconds_elapsed_for_frame = win32_get_seconds_elapsed(last_counter,
-																					win32_get_wall_clock());
-				
-				 	// TODO(Nader): This assert statement needs to be handled correctly.
-					//asserts(test_seconds_elapsed_for_frame < target_seconds_elapsed_per_frame);
-
-					while(seconds_elapsed_for_frame < target_seconds_elapsed_per_frame)
-					{
-						seconds_elapsed_for_frame = win32_get_seconds_elapsed(last_counter, win32_get_wall_clock());
-					}
-				}
-				else 
-				{
-					// TODO(Nader): Missed frame rate
-					// TODO(Nader): Logging
+					missed_frame = !win32_wait_for_frame_deadline(&pacer, frame_timer, frame_deadline);
 				}
 
 				end_counter = win32_get_wall_clock();
 				counter_elapsed = end_counter.QuadPart - last_counter.QuadPart;
 				f64 ms_per_frame = 1000.0f*win32_get_seconds_elapsed(last_counter, end_counter);
-				f64 fps = ((f64)global_performance_counter_frequency / (f64)counter_elapsed);
+				last_frame_seconds = (f32)(ms_per_frame / 1000.0);
+				frame_pacer_end_frame(&pacer, ms_per_frame / 1000.0, missed_frame);
 
+				// NOTE(Nader): Don't try to catch up after a missed frame, start over from now.
+				frame_deadline.QuadPart = (missed_frame ? end_counter.QuadPart : frame_deadline.QuadPart) +
+					counts_per_frame;
+				last_cycle_count = end_cycle_count;
 				last_counter = end_counter;
-				char metrics_text[256];
-				sprintf_s(metrics_text, sizeof(metrics_text), 
-					"counter_elapsed: %I64d  | qlobal_peformance_counter_frequency: %I64d \n", 
-						counter_elapsed,
-						global_performance_counter_frequency);
-				OutputDebugStringA(metrics_text);			
-
-				// char metrics_text[256];
-				// sprintf_s(
-				// 	metrics_text, 
-				// 	sizeof(metrics_text),
-				// 	"ms/f: %.02f | fps: %.02f \n", 
-				// 	ms_per_frame, 
-				// 	fps);
-				// OutputDebugStringA(metrics_text);
+
+				// NOTE(Nader): Per frame timings go to the profiler instead of OutputDebugStringA,
+				// 'P' dumps them.
+				if (profiler)
+				{
+					profiler_end_frame(profiler, ms_per_frame / 1000.0);
+					if (win32_state.profile_dump_requested)
+					{
+						win32_state.profile_dump_requested = false;
+						win32_dump_profile(&win32_state, profiler);
+					}
+				}
             }
 
 			GameInput *temp = new_input;
@@ -1,7 +1,49 @@
 #pragma once
 
+#define WIN32_STATE_FILE_NAME_COUNT MAX_PATH
+// NOTE(Nader): The most simulate steps one frame catches up on, see the game loop.
+#define WIN32_MAX_SIMULATE_STEPS_PER_FRAME 8
+
+typedef struct Win32GameCode
+{
+    HMODULE game_code_dll;
+    FILETIME dll_last_write_time;
+
+    // NOTE(Nader): Points at a stub that does nothing while no DLL is loaded.
+    game_simulate_function *simulate;
+    game_render_function *render;
+    b32 is_valid;
+} Win32GameCode;
+
+typedef struct Win32ThreadStartup
+{
+    PlatformWorkQueue *queue;
+    u32 thread_index;
+} Win32ThreadStartup;
+
 typedef struct Win32State 
 {
     u64 total_size;
     void *game_memory_block;
+
+    char exe_filename[WIN32_STATE_FILE_NAME_COUNT];
+    char *one_past_last_exe_filename_slash;
+
+    // NOTE(Nader): Input recording and playback, see replay.c. 'L' cycles
+    // idle -> recording -> looping playback -> idle.
+    char *replay_filepath;
+    b32 replay_toggle_requested;
+    HANDLE recording_handle;
+    GameInput last_recorded_input;
+
+    b32 is_playing_back;
+    void *playback_memory;
+    ReplayPlayback playback;
+
+    // NOTE(Nader): 'P' prints the profiler summary and writes a chrome trace.
+    char *trace_filepath;
+    b32 profile_dump_requested;
+
+    Win32ThreadStartup work_queue_startups[WORK_QUEUE_MAX_THREADS];
+    Win32ThreadStartup low_priority_queue_startups[LOW_PRIORITY_QUEUE_THREAD_COUNT];
 } Win32State;
\ No newline at end of file
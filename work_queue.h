@@ -0,0 +1,216 @@
+#pragma once
+
+/*
+
+NOTE(Nader): The lock free part of the work queue (see PlatformWorkQueue in blowback.h),
+shared by the platform layers. The platform owns the threads and the semaphore they sleep
+on, this file only moves entries around.
+
+Every thread that runs work has its own deque, thread 0 being the one that calls the
+game. A thread adds entries to the bottom of its own deque and takes them back from the
+bottom, newest first, so work it just made is still in its cache. A thread whose deque is
+empty steals the oldest entry from the top of someone else's. Only the owner ever touches
+the bottom and thieves race each other (and the owner, for the last entry) with a compare
+exchange on the top, so no locks. This is the Chase-Lev deque, with a fixed size array
+since we know how much work a frame can make.
+
+top and bottom only ever go up and are used modulo WORK_QUEUE_DEQUE_SIZE, they can wrap
+around u32 because everything compares their difference.
+
+*/
+
+#define WORK_QUEUE_MAX_THREADS 64
+// NOTE(Nader): Including thread 0. Low priority work is mostly waiting on the disk, it doesn't need a thread per core.
+#define LOW_PRIORITY_QUEUE_THREAD_COUNT 3
+// NOTE(Nader): Power of two. A thread that adds more than this without any being taken runs the entry itself.
+#define WORK_QUEUE_DEQUE_SIZE 1024
+
+typedef struct WorkQueueEntry
+{
+    platform_work_queue_callback *callback;
+    void *data;
+} WorkQueueEntry;
+
+typedef struct WorkQueueDeque
+{
+    // NOTE(Nader): Own cache lines, thieves hammer top while the owner works bottom.
+    u32 volatile top;
+    u8 top_padding[60];
+    u32 volatile bottom;
+    u8 bottom_padding[60];
+
+    WorkQueueEntry entries[WORK_QUEUE_DEQUE_SIZE];
+} WorkQueueDeque;
+
+struct PlatformWorkQueue
+{
+    // NOTE(Nader): Including thread 0.
+    u32 thread_count;
+
+    u32 volatile completion_goal;
+    u32 volatile completion_count;
+
+    // NOTE(Nader): The platform's semaphore, posted once per entry added.
+    void *semaphore;
+
+    // NOTE(Nader): Stats.
+    u32 volatile steal_count;
+    u32 volatile overflow_count;
+
+    WorkQueueDeque deques[WORK_QUEUE_MAX_THREADS];
+};
+
+// NOTE(Nader): Which deque belongs to the calling thread. Threads the platform didn't start for the queue are 0.
+global thread_local_storage u32 work_queue_thread_index;
+
+internal void
+work_queue_init(PlatformWorkQueue *queue, u32 thread_count, void *semaphore)
+{
+    asserts((thread_count > 0) && (thread_count <= WORK_QUEUE_MAX_THREADS));
+    queue->thread_count = thread_count;
+    queue->completion_goal = 0;
+    queue->completion_count = 0;
+    queue->semaphore = semaphore;
+    queue->steal_count = 0;
+    queue->overflow_count = 0;
+    for (u32 thread_index = 0; thread_index < WORK_QUEUE_MAX_THREADS; ++thread_index)
+    {
+        queue->deques[thread_index].top = 0;
+        queue->deques[thread_index].bottom = 0;
+    }
+}
+
+// NOTE(Nader): Owner only. Returns false when the deque is full.
+internal b32
+work_queue_push(WorkQueueDeque *deque, WorkQueueEntry entry)
+{
+    b32 result = false;
+    u32 bottom = deque->bottom;
+    u32 top = deque->top;
+    complete_previous_reads_before_future_reads;
+    if ((bottom - top) < WORK_QUEUE_DEQUE_SIZE)
+    {
+        deque->entries[bottom & (WORK_QUEUE_DEQUE_SIZE - 1)] = entry;
+        complete_previous_writes_before_future_writes;
+        deque->bottom = bottom + 1;
+        result = true;
+    }
+    return(result);
+}
+
+// NOTE(Nader): Owner only, newest first.
+internal b32
+work_queue_pop(WorkQueueDeque *deque, WorkQueueEntry *entry)
+{
+    b32 result = false;
+    u32 bottom = deque->bottom - 1;
+    deque->bottom = bottom;
+    // NOTE(Nader): A thief has to see the smaller bottom before we look at top, or we could both take the last entry.
+    complete_previous_writes_before_future_reads;
+    u32 top = deque->top;
+    if ((i32)(bottom - top) >= 0)
+    {
+        *entry = deque->entries[bottom & (WORK_QUEUE_DEQUE_SIZE - 1)];
+        result = true;
+        if (bottom == top)
+        {
+            // NOTE(Nader): The last entry, whoever moves top first gets it.
+            result = (atomic_compare_exchange_u32(&deque->top, top + 1, top) == top);
+            deque->bottom = top + 1;
+        }
+    }
+    else
+    {
+        deque->bottom = bottom + 1;
+    }
+    return(result);
+}
+
+// NOTE(Nader): Any thread, oldest first. Can fail because another thread got there first.
+internal b32
+work_queue_steal(WorkQueueDeque *deque, WorkQueueEntry *entry)
+{
+    b32 result = false;
+    u32 top = deque->top;
+    complete_previous_writes_before_future_reads;
+    u32 bottom = deque->bottom;
+    if ((i32)(bottom - top) > 0)
+    {
+        // NOTE(Nader): Read before the exchange, once top moves on the owner may reuse the slot.
+        *entry = deque->entries[top & (WORK_QUEUE_DEQUE_SIZE - 1)];
+        complete_previous_reads_before_future_reads;
+        result = (atomic_compare_exchange_u32(&deque->top, top + 1, top) == top);
+    }
+    return(result);
+}
+
+/*
+
+NOTE(Nader): Runs one entry: the newest from the calling thread's own deque, or failing
+that the oldest of another thread's, trying them in turn starting with the next one up.
+Returns false if it found nothing to do.
+
+*/
+internal b32
+work_queue_do_next_entry(PlatformWorkQueue *queue)
+{
+    u32 thread_index = work_queue_thread_index;
+    WorkQueueEntry entry;
+    b32 found = work_queue_pop(&queue->deques[thread_index], &entry);
+    for (u32 offset = 1; !found && (offset < queue->thread_count); ++offset)
+    {
+        u32 victim_index = (thread_index + offset) % queue->thread_count;
+        found = work_queue_steal(&queue->deques[victim_index], &entry);
+        if (found)
+        {
+            atomic_add_u32(&queue->steal_count, 1);
+        }
+    }
+
+    if (found)
+    {
+        entry.callback(queue, entry.data);
+        complete_previous_writes_before_future_writes;
+        atomic_add_u32(&queue->completion_count, 1);
+    }
+    return(found);
+}
+
+/*
+
+NOTE(Nader): The shared half of add_entry. Returns true if the entry was queued, and the
+platform should then wake a worker. A full deque runs the entry right here instead.
+
+*/
+internal b32
+work_queue_add_entry(PlatformWorkQueue *queue, platform_work_queue_callback *callback, void *data)
+{
+    WorkQueueEntry entry = {callback, data};
+    atomic_add_u32(&queue->completion_goal, 1);
+    b32 result = work_queue_push(&queue->deques[work_queue_thread_index], entry);
+    if (!result)
+    {
+        atomic_add_u32(&queue->overflow_count, 1);
+        callback(queue, data);
+        atomic_add_u32(&queue->completion_count, 1);
+    }
+    return(result);
+}
+
+// NOTE(Nader): The shared half of complete_all_work, for thread 0 only.
+internal void
+work_queue_complete_all_work(PlatformWorkQueue *queue)
+{
+    while (queue->completion_count != queue->completion_goal)
+    {
+        if (!work_queue_do_next_entry(queue))
+        {
+            _mm_pause();
+        }
+    }
+    complete_previous_reads_before_future_reads;
+
+    // NOTE(Nader): Nothing is in flight now, so it's safe to start counting over.
+    queue->completion_goal = 0;
+    queue->completion_count = 0;
+}